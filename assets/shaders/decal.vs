@@ -0,0 +1,28 @@
+#version 330
+
+// Input vertex attributes, the decal cross is shared by every instance
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+
+// Per instance: block position inside the chunk and blockmap tile
+in vec4 instanceData;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform vec2 blockmapSize;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+void main()
+{
+    // Find the tile in the blockmap, row by row like BlockType::TransformTexcoordsToBlockmap
+    vec2 tile = vec2(mod(instanceData.w, blockmapSize.x), floor(instanceData.w / blockmapSize.x));
+    fragTexCoord = (vertexTexCoord + tile) / blockmapSize;
+
+    // Decals are never shaded
+    fragColor = vec4(1.0);
+
+    gl_Position = mvp*vec4(vertexPosition + instanceData.xyz, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+in vec3 fragPosition;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float maxTextureLod; // Last mip level that still keeps the blockmap's tiles apart, one texel per tile
+uniform vec3 realMin;        // Box the real chunks are drawn in
+uniform vec3 realMax;
+uniform vec3 cameraPosition;
+uniform vec2 fogRange;       // Horizontal distances over which the terrain fades into the sky
+uniform vec4 fogColor;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Real chunks take over inside their box
+    if (all(greaterThanEqual(fragPosition, realMin)) && all(lessThan(fragPosition, realMax)))
+    {
+        discard;
+    }
+
+    // Every vertex points at the center of one tile, and its last level is that tile's average color
+    vec4 texelColor = textureLod(texture0, fragTexCoord, maxTextureLod);
+    vec3 color = texelColor.rgb*colDiffuse.rgb*fragColor.rgb;
+
+    float fog = smoothstep(fogRange.x, fogRange.y, length(fragPosition.xz - cameraPosition.xz));
+    finalColor = vec4(mix(color, fogColor.rgb, fog), 1.0);
+}
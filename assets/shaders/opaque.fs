@@ -7,6 +7,7 @@ in vec4 fragColor;
 // Input uniform values
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
+uniform float maxTextureLod; // Last mip level that still keeps the blockmap's tiles apart
 
 // Output fragment color
 out vec4 finalColor;
@@ -15,17 +16,16 @@ out vec4 finalColor;
 
 void main()
 {
-    // Texel color fetching from texture sampler
-    vec4 texelColor = texture(texture0, fragTexCoord);
+    // Texel color fetching from texture sampler, at the mip level the hardware would pick but never past maxTextureLod
+    vec2 texelCoord = fragTexCoord*vec2(textureSize(texture0, 0));
+    vec2 dx = dFdx(texelCoord), dy = dFdy(texelCoord);
+    float lod = 0.5*log2(max(dot(dx, dx), dot(dy, dy)));
+    vec4 texelColor = textureLod(texture0, fragTexCoord, clamp(lod, 0.0, maxTextureLod));
 
-    // NOTE: Implement here your fragment shader code
-    if (texelColor.a <= 0.5)
-    {
-        discard;
-    }
+    // No discard here, so the GPU can reject hidden fragments before shading them
 
     // final color is the color from the texture
     // times the tint color (colDiffuse)
-    // times the fragment color (interpolated vertex color)
-    finalColor = texelColor*colDiffuse*fragColor;
+    // times the fragment color (interpolated vertex color), always fully covering
+    finalColor = vec4(texelColor.rgb*colDiffuse.rgb*fragColor.rgb, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float maxTextureLod; // Last mip level that still keeps the blockmap's tiles apart
+
+// Output fragment color
+out vec4 finalColor;
+
+// NOTE: Add here your custom variables
+
+void main()
+{
+    // Texel color fetching from texture sampler, at the mip level the hardware would pick but never past maxTextureLod
+    vec2 texelCoord = fragTexCoord*vec2(textureSize(texture0, 0));
+    vec2 dx = dFdx(texelCoord), dy = dFdy(texelCoord);
+    float lod = 0.5*log2(max(dot(dx, dx), dot(dy, dy)));
+    vec4 texelColor = textureLod(texture0, fragTexCoord, clamp(lod, 0.0, maxTextureLod));
+
+    // Blended, but fully clear texels shouldn't hide what is drawn behind them later
+    if (texelColor.a <= 0.01)
+    {
+        discard;
+    }
+
+    // final color is the color from the texture
+    // times the tint color (colDiffuse)
+    // times the fragment color (interpolated vertex color)
+    finalColor = texelColor*colDiffuse*fragColor;
+}
\ No newline at end of file
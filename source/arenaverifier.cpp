@@ -0,0 +1,179 @@
+#include "arenaverifier.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "backend.hpp"
+#include "vertexarena.hpp"
+
+namespace ArenaVerifier
+{
+    static int VerifyAllocator()
+    {
+        // Every allocation has to land on the first free run long enough for it, exactly as a scan of the occupancy map finds it
+        constexpr int capacity = 1 << 14;
+        constexpr int operations = 5000;
+        ArenaAllocator allocator(capacity);
+        std::vector<bool> occupied(capacity);
+        std::vector<std::pair<int, int>> live; // First vertex and vertex count
+        int used = 0, allocations = 0, refused = 0;
+
+        const auto findFirstFit = [&](const int vertexCount)
+        {
+            for (int first = 0, run = 0; first + run < capacity; )
+            {
+                if (occupied[first + run])
+                {
+                    first += run + 1;
+                    run = 0;
+                }
+                else if (++run == vertexCount)
+                {
+                    return first;
+                }
+            }
+            return -1;
+        };
+        const auto findLargestFree = [&]
+        {
+            int largest = 0, run = 0;
+            for (int i = 0; i < capacity; i++)
+            {
+                run = occupied[i] ? 0 : run + 1;
+                largest = std::max(largest, run);
+            }
+            return largest;
+        };
+
+        std::mt19937 random(42);
+        const auto pick = [&](const int min, const int max) { return std::uniform_int_distribution(min, max)(random); };
+        for (int operation = 0; operation < operations; operation++)
+        {
+            if (live.empty() || pick(0, 4) < 3)
+            {
+                const int vertexCount = pick(1, 500);
+                const int expected = findFirstFit(vertexCount);
+                const int firstVertex = allocator.Allocate(vertexCount);
+                if (firstVertex != expected)
+                {
+                    std::cout << "FAIL allocator: operation " << operation << " allocated " << vertexCount << " vertices at " << firstVertex
+                              << ", the first fit is at " << expected << std::endl;
+                    return 1;
+                }
+                if (firstVertex < 0)
+                {
+                    refused++;
+                    continue;
+                }
+
+                std::fill_n(occupied.begin() + firstVertex, vertexCount, true);
+                live.emplace_back(firstVertex, vertexCount);
+                used += vertexCount;
+                allocations++;
+            }
+            else
+            {
+                const int index = pick(0, static_cast<int>(live.size()) - 1);
+                const auto [firstVertex, vertexCount] = live[index];
+                live[index] = live.back();
+                live.pop_back();
+
+                allocator.Free(firstVertex, vertexCount);
+                std::fill_n(occupied.begin() + firstVertex, vertexCount, false);
+                used -= vertexCount;
+            }
+
+            if (allocator.GetUsed() != used || allocator.GetLargestFreeBlock() != findLargestFree())
+            {
+                std::cout << "FAIL allocator: after operation " << operation << " " << allocator.GetUsed() << " vertices used, largest free block "
+                          << allocator.GetLargestFreeBlock() << ", expected " << used << " and " << findLargestFree() << std::endl;
+                return 1;
+            }
+        }
+
+        // Freeing everything has to merge the free blocks back into one
+        for (const auto& [firstVertex, vertexCount] : live)
+            allocator.Free(firstVertex, vertexCount);
+        if (allocator.GetUsed() != 0 || allocator.GetLargestFreeBlock() != capacity)
+        {
+            std::cout << "FAIL allocator: " << allocator.GetUsed() << " vertices still used and a largest free block of "
+                      << allocator.GetLargestFreeBlock() << " after freeing everything" << std::endl;
+            return 1;
+        }
+
+        std::cout << "PASS allocator (" << allocations << " allocations, " << refused << " refused for lack of room)" << std::endl;
+        return 0;
+    }
+
+    static int VerifyArena()
+    {
+        // Uploads move positions into world space, and everything drawn between Begin and End is one draw call
+        Backend::UseNull();
+        VertexArena arena(1024);
+
+        constexpr int vertexCount = 6;
+        std::vector<float> positions(vertexCount * 3, 1.0f), texcoords(vertexCount * 2), normals(vertexCount * 3);
+        std::vector<unsigned char> colors(vertexCount * 4);
+        Mesh mesh {};
+        mesh.vertexCount = vertexCount;
+        mesh.vertices = positions.data();
+        mesh.texcoords = texcoords.data();
+        mesh.normals = normals.data();
+        mesh.colors = colors.data();
+
+        const VertexArena::Allocation first = arena.Allocate(vertexCount), second = arena.Allocate(vertexCount);
+        const Backend::Stats before = Backend::GetStats();
+        arena.Upload(first, mesh, 0, vertexCount, Vector3{32, 0, 64});
+        arena.Upload(second, mesh, 0, vertexCount, Vector3{0, 32, 0});
+        const unsigned long long uploadedBytes = Backend::GetStats().uploadedBytes - before.uploadedBytes;
+        constexpr unsigned long long expectedBytes = 2 * vertexCount * (8 * sizeof(float) + 4 * sizeof(unsigned char));
+        if (uploadedBytes != expectedBytes)
+        {
+            std::cout << "FAIL arena uploads: " << uploadedBytes << " bytes sent, expected " << expectedBytes << std::endl;
+            return 1;
+        }
+
+        const Material material = Backend::LoadMaterialDefault();
+        const auto drawFrame = [&](const std::vector<MeshRange>& firstRanges, const std::vector<MeshRange>& secondRanges)
+        {
+            const Backend::Stats start = Backend::GetStats();
+            arena.Begin(material);
+            arena.Draw(first, firstRanges);
+            arena.Draw(second, secondRanges);
+            arena.End();
+            const Backend::Stats& end = Backend::GetStats();
+            return std::pair{end.drawCalls - start.drawCalls, end.vertices - start.vertices};
+        };
+
+        // Touching ranges, ranges with gaps between them, and nothing visible at all
+        if (drawFrame({{0, vertexCount}}, {{0, vertexCount}}) != std::pair{1ul, 12ull} ||
+            drawFrame({{0, 3}}, {{3, 3}}) != std::pair{1ul, 6ull} ||
+            drawFrame({}, {}) != std::pair{0ul, 0ull})
+        {
+            std::cout << "FAIL arena draws: ranges of one frame weren't drawn as a single multi-draw" << std::endl;
+            return 1;
+        }
+
+        // Growing copies everything over on the GPU, so nothing has to be uploaded again and it all still draws
+        const unsigned long long bytesBeforeGrowing = Backend::GetStats().uploadedBytes;
+        arena.Grow();
+        if (arena.GetAllocator().GetCapacity() != 2048 || !arena.IsValid(first) || !arena.IsValid(second) ||
+            arena.GetAllocator().GetLargestFreeBlock() != 2048 - 2 * vertexCount || Backend::GetStats().uploadedBytes != bytesBeforeGrowing ||
+            drawFrame({{0, vertexCount}}, {{0, vertexCount}}) != std::pair{1ul, 12ull})
+        {
+            std::cout << "FAIL arena growth: allocations were lost or uploaded again" << std::endl;
+            return 1;
+        }
+
+        std::cout << "PASS arena (" << uploadedBytes << " bytes uploaded, one draw call per frame, kept allocations while growing)" << std::endl;
+        return 0;
+    }
+
+    int Run()
+    {
+        const int failures = VerifyAllocator() + VerifyArena();
+        return failures == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless check of the vertex arena: the first-fit allocator against a plain per-vertex occupancy map under random
+// allocations and frees, and the arena's uploads, batched draws and growth on the null backend
+namespace ArenaVerifier
+{
+    // Runs every check and prints the results; returns a process exit code
+    int Run();
+}
@@ -0,0 +1,165 @@
+#include "atlasverifier.hpp"
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+#include "blocktype.hpp"
+#include "tileatlas.hpp"
+
+namespace AtlasVerifier
+{
+    constexpr int tileSize = 16;
+    constexpr int tilesX = BlockType::blockmapWidth, tilesY = BlockType::blockmapHeight;
+    constexpr int width = tileSize * tilesX, height = tileSize * tilesY;
+
+    using Texel = std::array<unsigned char, 4>;
+
+    struct Atlas
+    {
+        std::string name;
+        std::function<Texel(int tile, int x, int y)> texel;
+        // Every level that keeps tiles apart is handed the level, tile, and texel; returns an error or an empty string
+        std::function<std::string(int level, int tile, const Texel& texel)> check;
+    };
+
+    static Texel GetTileColor(const int tile)
+    {
+        return {static_cast<unsigned char>(tile * 16), static_cast<unsigned char>(255 - tile * 16), static_cast<unsigned char>(tile * 7 % 256), 255};
+    }
+
+    static bool IsCovered(const int x, const int y)
+    {
+        // A blade of grass: a thin diagonal stroke, a quarter of the tile at most
+        return std::abs(x - y) <= 1 || std::abs(x + y - tileSize) <= 1;
+    }
+
+    static const std::vector<Atlas>& GetAtlases()
+    {
+        static const std::vector<Atlas> atlases = {
+            {"Solid Tiles", [](const int tile, int, int) { return GetTileColor(tile); },
+             [](int, const int tile, const Texel& texel) -> std::string
+             {
+                 return texel == GetTileColor(tile) ? "" : "color of a neighboring tile bled in";
+             }},
+            {"Checkerboard Tiles", [](int, const int x, const int y) -> Texel
+             {
+                 return (x + y) % 2 == 0 ? Texel{0, 0, 0, 255} : Texel{255, 255, 255, 255};
+             },
+             [](const int level, int, const Texel& texel) -> std::string
+             {
+                 if (level == 0)
+                     return "";
+                 return texel[0] >= 127 && texel[0] <= 128 && texel[3] == 255 ? "" : "checkerboard doesn't average to gray";
+             }},
+            {"Clear Texels", [](int, const int x, const int y) -> Texel
+             {
+                 // Clear texels carry a color that must not show up once averaged
+                 return (x + y) % 2 == 0 ? Texel{255, 0, 0, 255} : Texel{0, 255, 0, 0};
+             },
+             [](const int level, int, const Texel& texel) -> std::string
+             {
+                 if (level == 0)
+                     return "";
+                 return texel[1] == 0 ? "" : "color of clear texels bled in";
+             }},
+        };
+
+        return atlases;
+    }
+
+    static std::vector<unsigned char> BuildPixels(const std::function<Texel(int tile, int x, int y)>& texel)
+    {
+        std::vector<unsigned char> pixels(width * height * 4);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                const Texel value = texel(y / tileSize * tilesX + x / tileSize, x % tileSize, y % tileSize);
+                std::copy(value.begin(), value.end(), pixels.begin() + (y * width + x) * 4);
+            }
+        }
+
+        return pixels;
+    }
+
+    static int CheckCoverage()
+    {
+        // Cutout tiles have to cover about as much at every level as at full size, or foliage fades into nothing in the distance
+        const std::vector<unsigned char> chain = TileAtlas::BuildMipChain(BuildPixels([](int, const int x, const int y) -> Texel
+        {
+            return IsCovered(x, y) ? Texel{40, 160, 40, 255} : Texel{0, 0, 0, 0};
+        }).data(), width, height, tilesX, tilesY);
+
+        int fullSize = 0;
+        for (int y = 0; y < tileSize; y++)
+            for (int x = 0; x < tileSize; x++)
+                fullSize += IsCovered(x, y);
+        const float expected = static_cast<float>(fullSize) / (tileSize * tileSize);
+
+        int failures = 0;
+        for (int level = 1; level < TileAtlas::GetTileLevelCount(tileSize, tileSize); level++)
+        {
+            const unsigned char* pixels = chain.data() + TileAtlas::GetLevelOffset(width, height, level);
+            const int levelWidth = width >> level, levelTile = tileSize >> level;
+            int covered = 0;
+            for (int y = 0; y < levelTile; y++)
+                for (int x = 0; x < levelTile; x++)
+                    covered += pixels[(y * levelWidth + x) * 4 + 3] > 127;
+
+            // Within a texel and a half of the full size coverage while tiles are 4x4 or larger, and never gone below that
+            const float actual = static_cast<float>(covered) / static_cast<float>(levelTile * levelTile);
+            const bool close = std::abs(actual - expected) * static_cast<float>(levelTile * levelTile) <= 1.5f;
+            if (levelTile >= 4 ? !close : covered == 0)
+            {
+                failures++;
+                std::cout << "    level " << level << " covers " << actual << " of the tile instead of " << expected << std::endl;
+            }
+        }
+
+        std::cout << (failures == 0 ? "PASS" : "FAIL") << " Cutout Coverage" << std::endl;
+        return failures;
+    }
+
+    int Run()
+    {
+        int failures = 0;
+        for (const auto& [name, texel, check] : GetAtlases())
+        {
+            const std::vector<unsigned char> chain = TileAtlas::BuildMipChain(BuildPixels(texel).data(), width, height, tilesX, tilesY);
+
+            // The whole chain, down to a single texel, has to be there for the texture to be complete
+            std::string error = chain.size() == TileAtlas::GetLevelOffset(width, height, 7) ? "" : "mip chain is incomplete";
+            int checked = 0;
+            for (int level = 0; level < TileAtlas::GetTileLevelCount(tileSize, tileSize) && error.empty(); level++)
+            {
+                const unsigned char* pixels = chain.data() + TileAtlas::GetLevelOffset(width, height, level);
+                const int levelWidth = width >> level, levelTile = tileSize >> level;
+                for (int y = 0; y < height >> level && error.empty(); y++)
+                {
+                    for (int x = 0; x < levelWidth && error.empty(); x++)
+                    {
+                        const unsigned char* value = pixels + (y * levelWidth + x) * 4;
+                        error = check(level, y / levelTile * tilesX + x / levelTile, Texel{value[0], value[1], value[2], value[3]});
+                        if (!error.empty())
+                            error += " at level " + std::to_string(level) + ", texel " + std::to_string(x) + "," + std::to_string(y);
+                        checked++;
+                    }
+                }
+            }
+
+            if (error.empty())
+            {
+                std::cout << "PASS " << name << " (" << checked << " texels)" << std::endl;
+                continue;
+            }
+
+            failures++;
+            std::cout << "FAIL " << name << ": " << error << std::endl;
+        }
+
+        failures += CheckCoverage();
+        return failures == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless check of the blockmap's CPU-built mip chain: no tile picks up texels of its neighbors at any level
+// that gets sampled, colors are averaged right and cutouts keep their coverage
+namespace AtlasVerifier
+{
+    // Builds mip chains of synthetic atlases and prints the results; returns a process exit code
+    int Run();
+}
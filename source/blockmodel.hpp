@@ -1,6 +1,8 @@
 #pragma once
 
 #include <raylib.h>
+#include <array>
+#include <bit>
 #include <vector>
 
 namespace BlockModel
@@ -16,6 +18,31 @@ namespace BlockModel
         Down =      1 << 5,
     };
 
+    static constexpr int DirectionCount = 6;
+
+    // Index of a direction in per-direction tables; faces without a direction get the last index
+    static constexpr int DirectionToIndex(const Direction direction)
+    {
+        if (direction == Direction::None)
+            return DirectionCount;
+        return std::countr_zero(static_cast<unsigned int>(direction));
+    }
+
+    // Offset to the neighboring block a face in the given direction looks at
+    static constexpr std::array<int, 3> DirectionToOffset(const Direction direction)
+    {
+        switch (direction)
+        {
+            case Direction::Forward:    return {0, 0, 1};
+            case Direction::Backward:   return {0, 0, -1};
+            case Direction::Left:       return {-1, 0, 0};
+            case Direction::Right:      return {1, 0, 0};
+            case Direction::Up:         return {0, 1, 0};
+            case Direction::Down:       return {0, -1, 0};
+            default:                    return {0, 0, 0};
+        }
+    }
+
     struct BlockFace
     {
         Direction facingDirection = Direction::None; // Facing direction of the block face
@@ -25,12 +52,21 @@ namespace BlockModel
         std::vector<std::array<float, 8>> vertices {};
     };
 
+    // Shape of a model, used to pick the specialized mesher path for it
+    enum class Kind
+    {
+        None,
+        FullBlock,
+        Decal,
+    };
+
     struct Model
     {
         std::vector<BlockFace> faces;
 
         // Useful info for generating opaqueMesh
         int triangleCount;
+        Kind kind = Kind::None;
     };
 
     static const Model None = {};
@@ -115,7 +151,7 @@ namespace BlockModel
                 {0, 0, 0,   0, -1, 0,    1, 0}
             },
         },
-    },12 };
+    },12, Kind::FullBlock };
 
     static const Model Decal =
     {{
@@ -171,5 +207,5 @@ namespace BlockModel
                 {0.1464466094, 1, 0.85355339059,   -0.70710678118, 0, -0.70710678118,   1, 0}
             },
         }
-    },8 };
+    },8, Kind::Decal };
 }
\ No newline at end of file
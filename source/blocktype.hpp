@@ -8,6 +8,15 @@
 
 namespace BlockType
 {
+    // Which pass a block's geometry is drawn in; only translucent geometry needs sorting and blending
+    enum class RenderPass
+    {
+        None,
+        Opaque,      // Drawn front to back without discard, so early depth testing stays on
+        Cutout,      // Alpha tested decals, drawn unsorted with depth writes
+        Translucent, // Glass, sorted back to front
+    };
+
     struct Type
     {
         std::string name;
@@ -36,6 +45,20 @@ namespace BlockType
 
     static constexpr unsigned int blockmapWidth = 4, blockmapHeight = 4;
 
+    static RenderPass GetRenderPass(const unsigned int blockType)
+    {
+        const Type& type = Types[blockType];
+        switch (type.model.kind)
+        {
+            case BlockModel::Kind::FullBlock:
+                return type.isTransparent ? RenderPass::Translucent : RenderPass::Opaque;
+            case BlockModel::Kind::Decal:
+                return RenderPass::Cutout;
+            default:
+                return RenderPass::None;
+        }
+    }
+
     static Vector2 TransformTexcoordsToBlockmap(Vector2 texcoords, unsigned int faceIndex, unsigned int blockType)
     {
         // Get position of texture based on index
@@ -4,9 +4,13 @@
 
 #include "chunk.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 #include "world.hpp"
+#include "backend.hpp"
 #include "blocktype.hpp"
 
 Chunk::Chunk(World* world, const Vector3 pos) :
@@ -17,188 +21,1121 @@ Chunk::Chunk(World* world, const Vector3 pos) :
 
 Chunk::~Chunk()
 {
-    validMesh = false;
-    reuploadMeshFlag = false;
-    UnloadMesh(opaqueMesh);
-    UnloadMesh(transparentMesh);
+    ReleaseGpuResources();
 }
 
-void Chunk::GenerateChunkMesh()
+void Chunk::ReleaseGpuResources()
 {
-    validMesh = false;
+    if (gpu == nullptr)
+        return;
 
-    // Allocate initial memory
-    int opaqueTriangleCount = 0, maxOpaqueTriangleCount = 10000, opaqueVertexCount = 0;
-    auto opaqueVertices = static_cast<float*>(MemAlloc(maxOpaqueTriangleCount * 3 * 3 * sizeof(float)));
-    auto opaqueNormals = static_cast<float*>(MemAlloc(maxOpaqueTriangleCount * 3 * 3 * sizeof(float)));
-    auto opaqueTexcoords = static_cast<float*>(MemAlloc(maxOpaqueTriangleCount * 3 * 2 * sizeof(float)));
+    // The last reference to a chunk can be dropped on any thread, so hand everything to the render thread
+    DecalBatch decalBuffers;
+    decalBuffers.vaoId = decals.vaoId;
+    decalBuffers.instanceVboId = decals.instanceVboId;
+    gpu->releaseQueue.Defer([arena = &gpu->opaqueArena, allocation = opaqueAllocation, transparent = transparentGpuMesh, decalBuffers]() mutable
+    {
+        arena->Free(allocation);
+        Backend::UnloadMesh(transparent);
+        decalBuffers.Unload();
+    });
 
-    int transparentTriangleCount = 0, maxTransparentTriangleCount = 2000, transparentVertexCount = 0;
-    auto transparentVertices = static_cast<float*>(MemAlloc(maxTransparentTriangleCount * 3 * 3 * sizeof(float)));
-    auto transparentNormals = static_cast<float*>(MemAlloc(maxTransparentTriangleCount * 3 * 3 * sizeof(float)));
-    auto transparentTexcoords = static_cast<float*>(MemAlloc(maxTransparentTriangleCount * 3 * 2 * sizeof(float)));
+    opaqueAllocation = {};
+    transparentGpuMesh = {};
+    decals.vaoId = decals.instanceVboId = 0;
+    decals.uploadedCount = 0;
+}
 
-    // Iterate through every block and calculate opaqueMesh
-    for (int x = 0; x < CHUNK_WIDTH; x++)
+// Room left behind every direction range of a full resolution mesh for faces added by edits
+static constexpr int spareFaceVerticesPerDirection = 8 * 6;
+
+// Vertex color brightness per number of occluding neighbors around a face corner (index 3 = unoccluded)
+static constexpr std::array<unsigned char, 4> ambientOcclusionBrightness = {95, 150, 205, 255};
+
+MeshBuffer::MeshBuffer(const int initialTriangleCount) : maxTriangleCount(initialTriangleCount)
+{}
+
+bool MeshBuffer::Reserve(const int additionalTriangleCount)
+{
+    // Allocate on first use, so chunks without any faces (e.g. all air) never touch the heap
+    if (vertices == nullptr)
     {
-        for (int y = 0; y < CHUNK_HEIGHT; y++)
+        vertices = static_cast<float*>(MemAlloc(maxTriangleCount * 3 * 3 * sizeof(float)));
+        normals = static_cast<float*>(MemAlloc(maxTriangleCount * 3 * 3 * sizeof(float)));
+        texcoords = static_cast<float*>(MemAlloc(maxTriangleCount * 3 * 2 * sizeof(float)));
+        colors = static_cast<unsigned char*>(MemAlloc(maxTriangleCount * 3 * 4 * sizeof(unsigned char)));
+        allocatedBytes.fetch_add(maxTriangleCount * 3 * (9 * sizeof(float) + 4 * sizeof(unsigned char)), std::memory_order_relaxed);
+    }
+
+    // Reallocate memory if mesh is larger than buffer
+    while (triangleCount + additionalTriangleCount > maxTriangleCount)
+    {
+        maxTriangleCount *= 2;
+        vertices = static_cast<float*>(MemRealloc(vertices, maxTriangleCount * 3 * 3 * sizeof(float)));
+        normals = static_cast<float*>(MemRealloc(normals, maxTriangleCount * 3 * 3 * sizeof(float)));
+        texcoords = static_cast<float*>(MemRealloc(texcoords, maxTriangleCount * 3 * 2 * sizeof(float)));
+        colors = static_cast<unsigned char*>(MemRealloc(colors, maxTriangleCount * 3 * 4 * sizeof(unsigned char)));
+        allocatedBytes.fetch_add(maxTriangleCount * 3 * (9 * sizeof(float) + 4 * sizeof(unsigned char)), std::memory_order_relaxed);
+
+        if (vertices == nullptr || normals == nullptr || texcoords == nullptr || colors == nullptr)
         {
-            for (int z = 0; z < CHUNK_WIDTH; z++)
-            {
-                AssembleMeshPieceFromBlockModel(x, y, z, this->data[x][y][z],
-                                                opaqueTriangleCount, maxOpaqueTriangleCount, opaqueVertexCount, opaqueVertices, opaqueNormals, opaqueTexcoords,
-                                                transparentTriangleCount, maxTransparentTriangleCount, transparentVertexCount, transparentVertices, transparentNormals, transparentTexcoords);
-            }
+            std::cout << "Failed to reallocate memory!!!!!!!!!!!!" << std::endl;
+            return false;
         }
     }
 
-    // Push opaque data to opaqueMesh
-    Mesh opaqueResult{};
-    opaqueResult.triangleCount = opaqueTriangleCount;
-    opaqueResult.vertexCount = opaqueVertexCount;
-    opaqueResult.vertices = opaqueVertices;
-    opaqueResult.normals = opaqueNormals;
-    opaqueResult.texcoords = opaqueTexcoords;
-    this->opaqueMesh = opaqueResult;
+    return true;
+}
+
+std::array<MeshRange, BlockModel::DirectionCount + 1> MeshBuffer::GroupFacesByDirection(const int spareVerticesPerDirection, FaceSlotMap* faceSlots)
+{
+    std::array<MeshRange, BlockModel::DirectionCount + 1> ranges {};
+    if (vertices == nullptr)
+        return ranges;
+
+    // Counting sort of the faces by direction, so every direction ends up as one contiguous range,
+    // followed by zeroed spare vertices that edits can later append faces into
+    for (const auto& face : faces)
+        ranges[face.direction].vertexCount += face.vertexCount;
+    for (int i = 1; i < ranges.size(); i++)
+        ranges[i].firstVertex = ranges[i - 1].firstVertex + ranges[i - 1].vertexCount + spareVerticesPerDirection;
+    const int totalVertexCount = vertexCount + spareVerticesPerDirection * BlockModel::DirectionCount;
+
+    const auto sortedVertices = static_cast<float*>(MemAlloc(totalVertexCount * 3 * sizeof(float)));
+    const auto sortedNormals = static_cast<float*>(MemAlloc(totalVertexCount * 3 * sizeof(float)));
+    const auto sortedTexcoords = static_cast<float*>(MemAlloc(totalVertexCount * 2 * sizeof(float)));
+    const auto sortedColors = static_cast<unsigned char*>(MemAlloc(totalVertexCount * 4 * sizeof(unsigned char)));
+    allocatedBytes.fetch_add(totalVertexCount * (9 * sizeof(float) + 4 * sizeof(unsigned char)), std::memory_order_relaxed);
+
+    std::array<int, BlockModel::DirectionCount + 1> cursors {};
+    for (int i = 0; i < ranges.size(); i++)
+        cursors[i] = ranges[i].firstVertex;
+
+    int source = 0;
+    for (const auto& [direction, count, voxel] : faces)
+    {
+        const int target = cursors[direction];
+        std::memcpy(sortedVertices + target * 3, vertices + source * 3, count * 3 * sizeof(float));
+        std::memcpy(sortedNormals + target * 3, normals + source * 3, count * 3 * sizeof(float));
+        std::memcpy(sortedTexcoords + target * 2, texcoords + source * 2, count * 2 * sizeof(float));
+        std::memcpy(sortedColors + target * 4, colors + source * 4, count * 4 * sizeof(unsigned char));
+
+        if (faceSlots != nullptr && voxel >= 0 && direction < BlockModel::DirectionCount)
+            (*faceSlots)[voxel * BlockModel::DirectionCount + direction] = target;
+
+        cursors[direction] += count;
+        source += count;
+    }
+
+    // The sorted copies are sized exactly, so this also trims the growth slack off the buffer
+    MemFree(vertices);
+    MemFree(normals);
+    MemFree(texcoords);
+    MemFree(colors);
+    vertices = sortedVertices;
+    normals = sortedNormals;
+    texcoords = sortedTexcoords;
+    colors = sortedColors;
+    vertexCount = totalVertexCount;
+    triangleCount = maxTriangleCount = totalVertexCount / 3;
+    faces.clear();
+
+    return ranges;
+}
+
+void MeshBuffer::Free()
+{
+    MemFree(vertices);
+    MemFree(normals);
+    MemFree(texcoords);
+    MemFree(colors);
+    vertices = normals = texcoords = nullptr;
+    colors = nullptr;
+}
+
+CpuMesh::CpuMesh(const Mesh& mesh) : mesh(mesh)
+{
+    residentBytes += GetByteSize(mesh);
+}
+
+CpuMesh::~CpuMesh()
+{
+    residentBytes -= GetByteSize(mesh);
+
+    // UnloadMesh would also release GPU buffers, which only the render thread may do
+    MemFree(mesh.vertices);
+    MemFree(mesh.normals);
+    MemFree(mesh.texcoords);
+    MemFree(mesh.colors);
+}
+
+std::shared_ptr<CpuMesh> CpuMesh::Copy() const
+{
+    Mesh result {};
+    result.triangleCount = mesh.triangleCount;
+    result.vertexCount = mesh.vertexCount;
+    if (mesh.vertices != nullptr)
+    {
+        result.vertices = static_cast<float*>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
+        result.normals = static_cast<float*>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
+        result.texcoords = static_cast<float*>(MemAlloc(mesh.vertexCount * 2 * sizeof(float)));
+        result.colors = static_cast<unsigned char*>(MemAlloc(mesh.vertexCount * 4 * sizeof(unsigned char)));
+        std::memcpy(result.vertices, mesh.vertices, mesh.vertexCount * 3 * sizeof(float));
+        std::memcpy(result.normals, mesh.normals, mesh.vertexCount * 3 * sizeof(float));
+        std::memcpy(result.texcoords, mesh.texcoords, mesh.vertexCount * 2 * sizeof(float));
+        std::memcpy(result.colors, mesh.colors, mesh.vertexCount * 4 * sizeof(unsigned char));
+    }
+
+    return std::make_shared<CpuMesh>(result);
+}
 
-    // Push transparent data to transparentMesh
-    Mesh transparentResult{};
-    transparentResult.triangleCount = transparentTriangleCount;
-    transparentResult.vertexCount = transparentVertexCount;
-    transparentResult.vertices = transparentVertices;
-    transparentResult.normals = transparentNormals;
-    transparentResult.texcoords = transparentTexcoords;
-    this->transparentMesh = transparentResult;
+size_t CpuMesh::GetByteSize(const Mesh& mesh)
+{
+    if (mesh.vertices == nullptr)
+        return 0;
+    return static_cast<size_t>(mesh.vertexCount) * (8 * sizeof(float) + 4 * sizeof(unsigned char));
+}
+
+Mesh MeshBuffer::ToMesh() const
+{
+    Mesh result{};
+    result.triangleCount = triangleCount;
+    result.vertexCount = vertexCount;
+    result.vertices = vertices;
+    result.normals = normals;
+    result.texcoords = texcoords;
+    result.colors = colors;
 
-    reuploadMeshFlag = true;
+    return result;
 }
 
-void Chunk::UploadChunkMesh()
+// Classic voxel corner AO: look at the two edge neighbors and the corner neighbor of each quad corner,
+// all in the layer of blocks the face is looking at. Returns their offsets from the face's block per quad corner.
+static std::array<std::array<std::array<int, 3>, 3>, 4> GetFaceOcclusionOffsets(const BlockModel::BlockFace& face)
 {
-    UploadMesh(&this->opaqueMesh, false);
-    UploadMesh(&this->transparentMesh, false);
+    const auto normal = BlockModel::DirectionToOffset(face.facingDirection);
+    const int normalAxis = normal[0] != 0 ? 0 : (normal[1] != 0 ? 1 : 2);
+    const int tangentAxisA = (normalAxis + 1) % 3;
+    const int tangentAxisB = (normalAxis + 2) % 3;
 
-    validMesh = true;
+    // Quad corners are vertices 0, 1, 2 and 5 of the face
+    std::array<std::array<std::array<int, 3>, 3>, 4> result {};
+    constexpr std::array<int, 4> cornerVertices = {0, 1, 2, 5};
+    for (int i = 0; i < 4; i++)
+    {
+        const auto& vertex = face.vertices[cornerVertices[i]];
+
+        auto& [sideA, sideB, corner] = result[i];
+        sideA = normal;
+        sideA[tangentAxisA] += vertex[tangentAxisA] > 0.5f ? 1 : -1;
+        sideB = normal;
+        sideB[tangentAxisB] += vertex[tangentAxisB] > 0.5f ? 1 : -1;
+        corner = sideA;
+        corner[tangentAxisB] = sideB[tangentAxisB];
+    }
+
+    return result;
 }
 
+static unsigned char GetCornerOcclusion(const bool occludedA, const bool occludedB, const bool occludedCorner)
+{
+    return (occludedA && occludedB) ? 0 : 3 - (occludedA + occludedB + occludedCorner);
+}
+
+// Coordinates are in units of the mesh's block scale
+template <typename OcclusionLookup>
+static std::array<unsigned char, 4> CalculateFaceAmbientOcclusion(const int x, const int y, const int z, const BlockModel::BlockFace& face, const OcclusionLookup& isOccluding)
+{
+    if (!Chunk::ambientOcclusion.load(std::memory_order_relaxed))
+        return {3, 3, 3, 3};
+
+    std::array<unsigned char, 4> result {};
+    const auto offsets = GetFaceOcclusionOffsets(face);
+    for (int i = 0; i < 4; i++)
+    {
+        const auto& [sideA, sideB, corner] = offsets[i];
+        result[i] = GetCornerOcclusion(isOccluding(x + sideA[0], y + sideA[1], z + sideA[2]), isOccluding(x + sideB[0], y + sideB[1], z + sideB[2]),
+                                       isOccluding(x + corner[0], y + corner[1], z + corner[2]));
+    }
 
-void Chunk::AssembleMeshPieceFromBlockModel(const int x, const int y, const int z, const unsigned int blockType,
-                                            int& opaqueTriangleCount, int& maxOpaqueTriangleCount, int& opaqueVertexCount, float* &opaqueVertices, float* &opaqueNormals, float* &opaqueTexcoords,
-                                            int& transparentTriangleCount, int& maxTransparentTriangleCount, int& transparentVertexCount, float* &transparentVertices, float* &transparentNormals, float* &transparentTexcoords) const
+    return result;
+}
+
+// Full block faces only differ by direction, so their AO neighbors are precomputed as Chunk::GetOcclusionNeighborhood bits
+static std::array<unsigned char, 4> CalculateFullBlockFaceAmbientOcclusion(const BlockModel::Direction direction, const uint32_t occluding)
 {
-    if (BlockType::Types[blockType].isTransparent)
+    static const auto cornerBits = []
     {
-        // Reallocate memory if opaqueMesh is larger than buffer
-        while (transparentTriangleCount + BlockType::Types[blockType].model.triangleCount > maxTransparentTriangleCount)
+        std::array<std::array<std::array<int, 3>, 4>, BlockModel::DirectionCount> result {};
+        for (const auto& face : BlockModel::FullBlock.faces)
         {
-            maxTransparentTriangleCount *= 2;
-            transparentVertices = static_cast<float*>(MemRealloc(transparentVertices, maxTransparentTriangleCount * 3 * 3 * sizeof(float)));
-            transparentNormals = static_cast<float*>(MemRealloc(transparentNormals, maxTransparentTriangleCount * 3 * 3 * sizeof(float)));
-            transparentTexcoords = static_cast<float*>(MemRealloc(transparentTexcoords, maxTransparentTriangleCount * 3 * 2 * sizeof(float)));
+            const auto offsets = GetFaceOcclusionOffsets(face);
+            for (int i = 0; i < 4; i++)
+            {
+                for (int n = 0; n < 3; n++)
+                {
+                    const auto& [dx, dy, dz] = offsets[i][n];
+                    result[BlockModel::DirectionToIndex(face.facingDirection)][i][n] = ((dx + 1) * 3 + dy + 1) * 3 + dz + 1;
+                }
+            }
+        }
+        return result;
+    }();
+
+    std::array<unsigned char, 4> result {};
+    for (int i = 0; i < 4; i++)
+    {
+        const auto& [sideA, sideB, corner] = cornerBits[BlockModel::DirectionToIndex(direction)][i];
+        result[i] = GetCornerOcclusion(occluding >> sideA & 1, occluding >> sideB & 1, occluding >> corner & 1);
+    }
+
+    return result;
+}
+
+// Writes one face of a block model into the buffer, offset to (x, y, z) and scaled by scale blocks
+static void AppendFace(MeshBuffer& buffer, const BlockModel::BlockFace& face, const unsigned int faceIndex, const unsigned int blockType,
+                       const int x, const int y, const int z, const int scale, const std::array<unsigned char, 4>& ambientOcclusion)
+{
+    std::array<int, 6> vertexOrder = {0, 1, 2, 3, 4, 5};
+    std::array<int, 6> vertexCorners = {0, 1, 2, 2, 1, 3};
+
+    // Split the quad along the brighter diagonal so the darkening interpolates evenly
+    if (ambientOcclusion[0] + ambientOcclusion[3] > ambientOcclusion[1] + ambientOcclusion[2])
+    {
+        vertexOrder = {0, 1, 5, 0, 5, 2};
+        vertexCorners = {0, 1, 3, 0, 3, 2};
+    }
+
+    for (int v = 0; v < face.vertices.size(); v++)
+    {
+        const auto& vertex = face.vertices[vertexOrder[v]];
 
-            if (transparentVertices == nullptr || transparentNormals == nullptr || transparentTexcoords == nullptr)
+        buffer.vertices[buffer.vertexCount*3] = vertex[0] * scale + x;
+        buffer.vertices[buffer.vertexCount*3 + 1] = vertex[1] * scale + y;
+        buffer.vertices[buffer.vertexCount*3 + 2] = vertex[2] * scale + z;
+
+        buffer.normals[buffer.vertexCount*3] = vertex[3];
+        buffer.normals[buffer.vertexCount*3 + 1] = vertex[4];
+        buffer.normals[buffer.vertexCount*3 + 2] = vertex[5];
+
+        const auto [texX, texY] = BlockType::TransformTexcoordsToBlockmap(Vector2{vertex[6], vertex[7]}, faceIndex, blockType);
+        buffer.texcoords[buffer.vertexCount*2] = texX;
+        buffer.texcoords[buffer.vertexCount*2 + 1] = texY;
+
+        const unsigned char brightness = ambientOcclusionBrightness[ambientOcclusion[vertexCorners[v]]];
+        buffer.colors[buffer.vertexCount*4] = brightness;
+        buffer.colors[buffer.vertexCount*4 + 1] = brightness;
+        buffer.colors[buffer.vertexCount*4 + 2] = brightness;
+        buffer.colors[buffer.vertexCount*4 + 3] = 255;
+
+        buffer.vertexCount++;
+    }
+    buffer.triangleCount += face.triangleCount;
+    const int voxel = scale == 1 ? (x * CHUNK_HEIGHT + y) * CHUNK_WIDTH + z : -1;
+    buffer.faces.push_back({static_cast<unsigned char>(BlockModel::DirectionToIndex(face.facingDirection)), static_cast<int>(face.vertices.size()), voxel});
+}
+
+void Chunk::GenerateChunkMesh(const int lodLevel, const int lodSeams)
+{
+    this->lodLevel = lodLevel;
+    this->lodSeams = lodSeams;
+    ComputeColumnSummaries();
+
+    // Allocate initial memory
+    MeshBuffer opaque(10000);
+    MeshBuffer transparent(2000);
+    std::vector<DecalInstance> decalInstances;
+
+    if (lodLevel > 0)
+    {
+        AssembleLodMesh(1 << lodLevel, opaque);
+    }
+    else
+    {
+        // Iterate through every block and calculate opaqueMesh
+        const auto& kernels = GetMeshKernels();
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            for (int y = 0; y < CHUNK_HEIGHT; y++)
             {
-                std::cout << "Failed to reallocate memory!!!!!!!!!!!!" << std::endl;
-                return;
+                // Skip whole rows of air at once, they never produce faces
+                const auto& row = this->data[x][y];
+                if (std::ranges::all_of(row, [](const int block) { return block == 0; }))
+                    continue;
+
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                {
+                    const unsigned int blockType = row[z];
+                    if (blockType == 0)
+                        continue;
+
+                    (this->*kernels[blockType])(x, y, z, blockType, opaque, transparent, decalInstances);
+                }
             }
         }
+    }
 
-        const unsigned int faceCount = BlockType::Types[blockType].model.faces.size();
-        for (int i = 0; i < faceCount; i++)
+    if (lodSeams != 0)
+        AssembleLodSkirts(1 << lodLevel, opaque);
+
+    // Push data to meshes, with opaque faces grouped so back-facing directions can be skipped when drawing.
+    // Full resolution meshes remember where each face went and keep room for a few more, so small edits can patch them in place.
+    opaqueFaceSlots.clear();
+    for (auto& slots : freeFaceSlots)
+        slots.clear();
+
+    // The previous build stays drawn until this one is uploaded
+    auto build = std::make_shared<ChunkMesh>();
+    if (lodLevel == 0)
+        build->opaqueRanges = opaque.GroupFacesByDirection(spareFaceVerticesPerDirection, &opaqueFaceSlots);
+    else
+        build->opaqueRanges = opaque.GroupFacesByDirection();
+    build->opaque = std::make_shared<const CpuMesh>(opaque.ToMesh());
+    build->transparent = std::make_shared<const CpuMesh>(transparent.ToMesh());
+    build->decals = std::make_shared<const std::vector<DecalInstance>>(std::move(decalInstances));
+    build->faceConnectivity = ComputeFaceConnectivity();
+    this->mesh = std::move(build);
+}
+
+bool Chunk::UploadChunkMesh(ChunkGpuContext& gpu, const std::shared_ptr<const ChunkMesh>& build)
+{
+    this->gpu = &gpu;
+    VertexArena& arena = gpu.opaqueArena;
+    const Mesh& opaqueMesh = build->opaque->mesh;
+
+    // A patch of what is on the GPU only needs its rewritten vertices sent over
+    if (uploadedMesh != nullptr && build->patchedFrom == uploadedMesh->id && arena.IsValid(opaqueAllocation))
+    {
+        for (const MeshRange& range : build->patchedRanges)
+            arena.Upload(opaqueAllocation, opaqueMesh, range.firstVertex, range.vertexCount, worldPosition);
+    }
+    else
+    {
+        // Opaque geometry goes into the shared arena, translucent geometry keeps its own mesh as it's sorted per chunk.
+        // If the arena is full it grows, which invalidates every allocation anyway.
+        arena.Free(opaqueAllocation);
+        opaqueAllocation = arena.Allocate(opaqueMesh.vertexCount);
+        if (!arena.IsValid(opaqueAllocation))
+            return false;
+        arena.Upload(opaqueAllocation, opaqueMesh, 0, opaqueMesh.vertexCount, worldPosition);
+    }
+    drawnOpaqueRanges = build->opaqueRanges;
+
+    // Builds share the parts that didn't change, those stay where they are. So does everything of a build that has to go up
+    // again after the arena grew without copying.
+    if (uploadedMesh == nullptr || uploadedMesh->transparentId != build->transparentId)
+    {
+        Backend::UnloadMesh(transparentGpuMesh);
+
+        // Upload a copy, so the CPU arrays stay with the build and the GPU handles with transparentGpuMesh
+        Mesh uploaded = build->transparent->mesh;
+        Backend::UploadMesh(&uploaded, false);
+        transparentGpuMesh = {};
+        transparentGpuMesh.vertexCount = uploaded.vertexCount;
+        transparentGpuMesh.triangleCount = uploaded.triangleCount;
+        transparentGpuMesh.vaoId = uploaded.vaoId;
+        transparentGpuMesh.vboId = uploaded.vboId;
+    }
+
+    if (uploadedMesh == nullptr || uploadedMesh->decals != build->decals)
+    {
+        decals.instances = *build->decals;
+        gpu.decalRenderer.Upload(decals);
+    }
+
+    uploadedMesh = build->WithoutGeometry();
+    uploadedMeshId = build->id;
+
+    return true;
+}
+
+bool Chunk::NeedsUpload(const std::shared_ptr<const ChunkMesh>& build, const VertexArena& arena) const
+{
+    // A new build, or the opaque part dropped when the arena grew without copying
+    return uploadedMesh == nullptr || build->id != uploadedMesh->id || !arena.IsValid(opaqueAllocation);
+}
+
+size_t Chunk::GetUploadByteSize(const ChunkMesh& build) const
+{
+    constexpr size_t vertexSize = 8 * sizeof(float) + 4 * sizeof(unsigned char);
+    if (uploadedMesh != nullptr && build.patchedFrom == uploadedMesh->id)
+    {
+        size_t vertexCount = 0;
+        for (const MeshRange& range : build.patchedRanges)
+            vertexCount += range.vertexCount;
+        return vertexCount * vertexSize + (build.decals != uploadedMesh->decals ? build.decals->size() * sizeof(DecalInstance) : 0);
+    }
+
+    if (!build.HasGeometry())
+        return 0;
+    return (build.opaque->mesh.vertexCount + build.transparent->mesh.vertexCount) * vertexSize + build.decals->size() * sizeof(DecalInstance);
+}
+
+bool Chunk::PatchBlockFaces(const int editX, const int editY, const int editZ)
+{
+    // Only full resolution meshes that still have their geometry and know where their faces live can be patched.
+    // Skirts are left to full remeshes, they only exist far from the player anyway.
+    if (lodLevel != 0 || lodSeams != 0 || mesh == nullptr || !mesh->HasGeometry() || opaqueFaceSlots.empty())
+        return false;
+
+    const int minX = std::max(editX - 1, 0), maxX = std::min(editX + 1, static_cast<int>(CHUNK_WIDTH) - 1);
+    const int minY = std::max(editY - 1, 0), maxY = std::min(editY + 1, static_cast<int>(CHUNK_HEIGHT) - 1);
+    const int minZ = std::max(editZ - 1, 0), maxZ = std::min(editZ + 1, static_cast<int>(CHUNK_WIDTH) - 1);
+
+    // Glass faces depend on their neighbors too, but live in the unpatchable transparent mesh
+    for (int x = minX; x <= maxX; x++)
+        for (int y = minY; y <= maxY; y++)
+            for (int z = minZ; z <= maxZ; z++)
+                if (BlockType::GetRenderPass(this->data[x][y][z]) == BlockType::RenderPass::Translucent)
+                    return false;
+
+    // Published builds are immutable, patch a copy. The slot bookkeeping is only committed along with it.
+    const std::shared_ptr<CpuMesh> opaque = mesh->opaque->Copy();
+    std::array<MeshRange, BlockModel::DirectionCount + 1> opaqueRanges = mesh->opaqueRanges;
+    FaceSlotMap patchedSlots = opaqueFaceSlots;
+    std::array<std::vector<int>, BlockModel::DirectionCount> patchedFreeSlots = freeFaceSlots;
+    std::vector<MeshRange> patchedRanges;
+
+    // An edit can change which faces of the blocks around it exist, and the AO of all of them
+    const auto isOccluding = [this](const int x, const int y, const int z) { return IsOccludingAtLocal(x, y, z); };
+    MeshBuffer scratch(2);
+    bool patched = true;
+    for (int x = minX; x <= maxX && patched; x++)
+    {
+        for (int y = minY; y <= maxY && patched; y++)
         {
-            // Check for occlusion
-            auto [globalX, globalY, globalZ] = LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-            const int worldCoordX = static_cast<int>(globalX);
-            const int worldCoordY = static_cast<int>(globalY);
-            const int worldCoordZ = static_cast<int>(globalZ);
-            if
-            (
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Right)       && !world->IsBlockAtCoordsTransparent(worldCoordX+1, worldCoordY, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Left)        && !world->IsBlockAtCoordsTransparent(worldCoordX-1, worldCoordY, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Up)          && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY+1, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Down)        && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY-1, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Forward)     && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY, worldCoordZ+1)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Backward)    && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY, worldCoordZ-1))
-            )
+            for (int z = minZ; z <= maxZ && patched; z++)
             {
-                continue;
+                const unsigned int blockType = this->data[x][y][z];
+                const BlockType::Type& type = BlockType::Types[blockType];
+                const int voxel = (x * CHUNK_HEIGHT + y) * CHUNK_WIDTH + z;
+
+                const bool isOpaqueFullBlock = BlockType::GetRenderPass(blockType) == BlockType::RenderPass::Opaque;
+
+                for (int direction = 0; direction < BlockModel::DirectionCount; direction++)
+                {
+                    const int key = voxel * BlockModel::DirectionCount + direction;
+                    const auto slot = patchedSlots.find(key);
+
+                    int faceIndex = -1;
+                    for (int i = 0; isOpaqueFullBlock && i < type.model.faces.size(); i++)
+                    {
+                        if (BlockModel::DirectionToIndex(type.model.faces[i].facingDirection) == direction)
+                            faceIndex = i;
+                    }
+
+                    bool visible = false;
+                    if (faceIndex >= 0)
+                    {
+                        const auto [nx, ny, nz] = BlockModel::DirectionToOffset(type.model.faces[faceIndex].facingDirection);
+                        visible = !IsOccludingAtLocal(x + nx, y + ny, z + nz);
+                    }
+
+                    // Faces that disappeared become degenerate, and their slot can be reused
+                    if (!visible)
+                    {
+                        if (slot != patchedSlots.end())
+                        {
+                            ClearOpaqueFaceSlot(opaque->mesh, slot->second, 6);
+                            patchedRanges.push_back({slot->second, 6});
+                            patchedFreeSlots[direction].push_back(slot->second);
+                            patchedSlots.erase(slot);
+                        }
+                        continue;
+                    }
+
+                    const BlockModel::BlockFace& face = type.model.faces[faceIndex];
+                    scratch.vertexCount = scratch.triangleCount = 0;
+                    scratch.faces.clear();
+                    scratch.Reserve(face.triangleCount);
+                    AppendFace(scratch, face, faceIndex, blockType, x, y, z, 1, CalculateFaceAmbientOcclusion(x, y, z, face, isOccluding));
+
+                    // Rewrite faces in place, otherwise reuse a freed slot or grow into the spare room of the direction
+                    int target;
+                    const int capacityEnd = direction + 1 < opaqueRanges.size() ? opaqueRanges[direction + 1].firstVertex : opaque->mesh.vertexCount;
+                    if (slot != patchedSlots.end())
+                    {
+                        target = slot->second;
+                    }
+                    else if (!patchedFreeSlots[direction].empty())
+                    {
+                        target = patchedFreeSlots[direction].back();
+                        patchedFreeSlots[direction].pop_back();
+                    }
+                    else if (opaqueRanges[direction].firstVertex + opaqueRanges[direction].vertexCount + scratch.vertexCount <= capacityEnd)
+                    {
+                        target = opaqueRanges[direction].firstVertex + opaqueRanges[direction].vertexCount;
+                        opaqueRanges[direction].vertexCount += scratch.vertexCount;
+                    }
+                    else
+                    {
+                        // Out of room, the buffer needs a full rebuild
+                        patched = false;
+                        break;
+                    }
+
+                    WriteOpaqueFaceSlot(opaque->mesh, target, scratch);
+                    patchedRanges.push_back({target, scratch.vertexCount});
+                    patchedSlots[key] = target;
+                }
             }
+        }
+    }
+    scratch.Free();
+
+    if (!patched)
+        return false;
 
-            for (auto & vertex : BlockType::Types[blockType].model.faces[i].vertices)
+    // The edited block may have become or stopped being a decal
+    std::shared_ptr<const std::vector<DecalInstance>> decals = mesh->decals;
+    uint64_t faceConnectivity = mesh->faceConnectivity;
+    if (editX >= 0 && editX < CHUNK_WIDTH && editY >= 0 && editY < CHUNK_HEIGHT && editZ >= 0 && editZ < CHUNK_WIDTH)
+    {
+        const auto atEdit = [&](const DecalInstance& decal) { return decal.x == editX && decal.y == editY && decal.z == editZ; };
+        const unsigned int blockType = this->data[editX][editY][editZ];
+        const bool isDecal = BlockType::Types[blockType].model.kind == BlockModel::Kind::Decal;
+        if (isDecal || std::ranges::any_of(*decals, atEdit))
+        {
+            auto instances = std::make_shared<std::vector<DecalInstance>>(*decals);
+            std::erase_if(*instances, atEdit);
+            if (isDecal)
             {
-                transparentVertices[transparentVertexCount*3] = vertex[0] + x;
-                transparentVertices[transparentVertexCount*3 + 1] = vertex[1] + y;
-                transparentVertices[transparentVertexCount*3 + 2] = vertex[2] + z;
+                instances->push_back({static_cast<unsigned char>(editX), static_cast<unsigned char>(editY), static_cast<unsigned char>(editZ),
+                                      static_cast<unsigned char>(BlockType::Types[blockType].textureIndices[0])});
+            }
+            decals = std::move(instances);
+        }
+
+        faceConnectivity = ComputeFaceConnectivity();
+        ComputeColumnSummary(editX, editZ);
+    }
 
-                transparentNormals[transparentVertexCount*3] = vertex[3];
-                transparentNormals[transparentVertexCount*3 + 1] = vertex[4];
-                transparentNormals[transparentVertexCount*3 + 2] = vertex[5];
+    auto build = std::make_shared<ChunkMesh>();
+    build->opaque = opaque;
+    build->transparent = mesh->transparent;
+    build->transparentId = mesh->transparentId;
+    build->opaqueRanges = opaqueRanges;
+    build->decals = std::move(decals);
+    build->faceConnectivity = faceConnectivity;
+    build->patchedFrom = mesh->id;
+    build->patchedRanges = std::move(patchedRanges);
+    this->mesh = std::move(build);
+    opaqueFaceSlots = std::move(patchedSlots);
+    freeFaceSlots = std::move(patchedFreeSlots);
 
-                const auto [texX, texY] = BlockType::TransformTexcoordsToBlockmap(Vector2{vertex[6], vertex[7]}, i, blockType);
-                transparentTexcoords[transparentVertexCount*2] = texX;
-                transparentTexcoords[transparentVertexCount*2 + 1] = texY;
+    return true;
+}
 
-                transparentVertexCount++;
+void Chunk::FreeUploadedGeometry()
+{
+    if (mesh == nullptr || !mesh->HasGeometry() || uploadedMeshId != mesh->id)
+        return;
+
+    // Face slots only serve patching, which needs the geometry
+    mesh = mesh->WithoutGeometry();
+    opaqueFaceSlots = FaceSlotMap();
+    freeFaceSlots = {};
+}
+
+void Chunk::WriteOpaqueFaceSlot(Mesh& opaque, const int firstVertex, const MeshBuffer& face)
+{
+    std::memcpy(opaque.vertices + firstVertex * 3, face.vertices, face.vertexCount * 3 * sizeof(float));
+    std::memcpy(opaque.normals + firstVertex * 3, face.normals, face.vertexCount * 3 * sizeof(float));
+    std::memcpy(opaque.texcoords + firstVertex * 2, face.texcoords, face.vertexCount * 2 * sizeof(float));
+    std::memcpy(opaque.colors + firstVertex * 4, face.colors, face.vertexCount * 4 * sizeof(unsigned char));
+}
+
+void Chunk::ClearOpaqueFaceSlot(Mesh& opaque, const int firstVertex, const int vertexCount)
+{
+    // Collapse the face into a point so it no longer covers any pixels
+    std::memset(opaque.vertices + firstVertex * 3, 0, vertexCount * 3 * sizeof(float));
+}
+
+unsigned char Chunk::GetBlockAtLocal(const int x, const int y, const int z) const
+{
+    // Stay inside this chunk when possible, only ask the world for blocks across the border
+    if (x >= 0 && x < CHUNK_WIDTH && y >= 0 && y < CHUNK_HEIGHT && z >= 0 && z < CHUNK_WIDTH)
+        return this->data[x][y][z];
+
+    // Chunks without a world (fixtures) are surrounded by air
+    if (world == nullptr)
+        return 0;
+
+    auto [globalX, globalY, globalZ] = LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+    return world->GetBlockAt(static_cast<int>(globalX), static_cast<int>(globalY), static_cast<int>(globalZ));
+}
+
+bool Chunk::IsOccludingAtLocal(const int x, const int y, const int z) const
+{
+    return !BlockType::Types[GetBlockAtLocal(x, y, z)].isTransparent;
+}
+
+uint32_t Chunk::GetOcclusionNeighborhood(const int x, const int y, const int z, const int visibleFaces) const
+{
+    // Only the 3x3 layer in front of each visible face matters, and neighboring faces share a row of it. Which blocks
+    // that is only depends on the visible faces, so it is worked out once per combination of them.
+    struct Neighbor
+    {
+        int bit;
+        int dx, dy, dz;
+        int offset; // Into the flattened block data
+    };
+    struct Neighborhood
+    {
+        std::array<Neighbor, 26> neighbors;
+        int count = 0;
+    };
+    static const auto neighborhoods = []
+    {
+        std::array<Neighborhood, 1 << BlockModel::DirectionCount> result {};
+        for (int mask = 0; mask < result.size(); mask++)
+        {
+            uint32_t gathered = 0;
+            for (int i = 0; i < BlockModel::FullBlock.faces.size(); i++)
+            {
+                if ((mask & 1 << i) == 0)
+                    continue;
+
+                const auto normal = BlockModel::DirectionToOffset(BlockModel::FullBlock.faces[i].facingDirection);
+                for (int dx = normal[0] != 0 ? normal[0] : -1; dx <= (normal[0] != 0 ? normal[0] : 1); dx++)
+                {
+                    for (int dy = normal[1] != 0 ? normal[1] : -1; dy <= (normal[1] != 0 ? normal[1] : 1); dy++)
+                    {
+                        for (int dz = normal[2] != 0 ? normal[2] : -1; dz <= (normal[2] != 0 ? normal[2] : 1); dz++)
+                        {
+                            const int bit = ((dx + 1) * 3 + dy + 1) * 3 + dz + 1;
+                            if (gathered & 1u << bit)
+                                continue;
+
+                            gathered |= 1u << bit;
+                            result[mask].neighbors[result[mask].count++] = {bit, dx, dy, dz, (dx * static_cast<int>(CHUNK_HEIGHT) + dy) * static_cast<int>(CHUNK_WIDTH) + dz};
+                        }
+                    }
+                }
             }
-            transparentTriangleCount += BlockType::Types[blockType].model.faces[i].triangleCount;
         }
+        return result;
+    }();
+    static const auto occludes = []
+    {
+        std::array<bool, 256> result {};
+        for (int i = 0; i < BlockType::Types.size(); i++)
+            result[i] = !BlockType::Types[i].isTransparent;
+        return result;
+    }();
+
+    const Neighborhood& neighborhood = neighborhoods[visibleFaces];
+    uint32_t result = 0;
+
+    // Blocks away from the border can skip the bounds checks of GetBlockAtLocal
+    if (x > 0 && x < CHUNK_WIDTH - 1 && y > 0 && y < CHUNK_HEIGHT - 1 && z > 0 && z < CHUNK_WIDTH - 1)
+    {
+        const unsigned char* block = this->data[0][0].data() + (x * CHUNK_HEIGHT + y) * CHUNK_WIDTH + z;
+        for (int i = 0; i < neighborhood.count; i++)
+            result |= static_cast<uint32_t>(occludes[block[neighborhood.neighbors[i].offset]]) << neighborhood.neighbors[i].bit;
+        return result;
     }
-    else
+
+    for (int i = 0; i < neighborhood.count; i++)
     {
-        // Reallocate memory if opaqueMesh is larger than buffer
-        while (opaqueTriangleCount + BlockType::Types[blockType].model.triangleCount > maxOpaqueTriangleCount)
+        const Neighbor& neighbor = neighborhood.neighbors[i];
+        result |= static_cast<uint32_t>(occludes[GetBlockAtLocal(x + neighbor.dx, y + neighbor.dy, z + neighbor.dz)]) << neighbor.bit;
+    }
+    return result;
+}
+
+unsigned char Chunk::GetLodCell(const int cellX, const int cellY, const int cellZ, const int scale) const
+{
+    // A cell is solid when at least half of it is opaque, and takes the type of its topmost opaque block
+    // so grass stays on top of distant hills
+    int opaqueCount = 0, topY = -1;
+    unsigned char topType = 0;
+    for (int x = cellX * scale; x < (cellX + 1) * scale; x++)
+    {
+        for (int y = cellY * scale; y < (cellY + 1) * scale; y++)
         {
-            maxOpaqueTriangleCount *= 2;
-            opaqueVertices = static_cast<float*>(MemRealloc(opaqueVertices, maxOpaqueTriangleCount * 3 * 3 * sizeof(float)));
-            opaqueNormals = static_cast<float*>(MemRealloc(opaqueNormals, maxOpaqueTriangleCount * 3 * 3 * sizeof(float)));
-            opaqueTexcoords = static_cast<float*>(MemRealloc(opaqueTexcoords, maxOpaqueTriangleCount * 3 * 2 * sizeof(float)));
+            for (int z = cellZ * scale; z < (cellZ + 1) * scale; z++)
+            {
+                const int block = this->data[x][y][z];
+                if (BlockType::Types[block].isTransparent)
+                    continue;
 
-            if (opaqueVertices == nullptr || opaqueNormals == nullptr || opaqueTexcoords == nullptr)
+                opaqueCount++;
+                if (y > topY)
+                {
+                    topY = y;
+                    topType = block;
+                }
+            }
+        }
+    }
+
+    return opaqueCount * 2 >= scale * scale * scale ? topType : 0;
+}
+
+unsigned char Chunk::GetLodCellAtLocal(const int cellX, const int cellY, const int cellZ, const int scale) const
+{
+    const int cellsX = CHUNK_WIDTH / scale, cellsY = CHUNK_HEIGHT / scale, cellsZ = CHUNK_WIDTH / scale;
+    const int offsetX = static_cast<int>(std::floor(static_cast<float>(cellX) / cellsX));
+    const int offsetY = static_cast<int>(std::floor(static_cast<float>(cellY) / cellsY));
+    const int offsetZ = static_cast<int>(std::floor(static_cast<float>(cellZ) / cellsZ));
+
+    if (offsetX == 0 && offsetY == 0 && offsetZ == 0)
+        return GetLodCell(cellX, cellY, cellZ, scale);
+
+    if (world == nullptr)
+        return 0;
+
+    // Neighbors are downsampled at this chunk's scale, whatever level they are meshed at themselves
+    const std::shared_ptr<Chunk> neighbor = world->GetChunkAt(Vector3{position.x + offsetX, position.y + offsetY, position.z + offsetZ});
+    if (neighbor == nullptr)
+        return 0;
+
+    return neighbor->GetLodCell(cellX - offsetX * cellsX, cellY - offsetY * cellsY, cellZ - offsetZ * cellsZ, scale);
+}
+
+void Chunk::AssembleLodMesh(const int scale, MeshBuffer& opaque) const
+{
+    // Only opaque blocks count toward a cell, so LOD meshes have no translucent mesh and no decals. Glass simply
+    // disappears at a distance, and decals are past their draw distance well before the first LOD ring anyway.
+    // Downsample the chunk into scale^3 cells first, so every cell is only evaluated once
+    const int cellsX = CHUNK_WIDTH / scale, cellsY = CHUNK_HEIGHT / scale, cellsZ = CHUNK_WIDTH / scale;
+    std::vector<unsigned char> cells(cellsX * cellsY * cellsZ);
+    for (int x = 0; x < cellsX; x++)
+        for (int y = 0; y < cellsY; y++)
+            for (int z = 0; z < cellsZ; z++)
+                cells[(x * cellsY + y) * cellsZ + z] = GetLodCell(x, y, z, scale);
+
+    const auto isCellSolid = [&](const int x, const int y, const int z)
+    {
+        if (x >= 0 && x < cellsX && y >= 0 && y < cellsY && z >= 0 && z < cellsZ)
+            return cells[(x * cellsY + y) * cellsZ + z] != 0;
+        return GetLodCellAtLocal(x, y, z, scale) != 0;
+    };
+
+    for (int x = 0; x < cellsX; x++)
+    {
+        for (int y = 0; y < cellsY; y++)
+        {
+            for (int z = 0; z < cellsZ; z++)
             {
-                std::cout << "Failed to reallocate memory!!!!!!!!!!!!" << std::endl;
-                return;
+                const unsigned char blockType = cells[(x * cellsY + y) * cellsZ + z];
+                if (blockType == 0)
+                    continue;
+
+                const BlockModel::Model& model = BlockType::Types[blockType].model;
+                if (!opaque.Reserve(model.triangleCount))
+                    return;
+
+                for (int i = 0; i < model.faces.size(); i++)
+                {
+                    const BlockModel::BlockFace& face = model.faces[i];
+                    const auto [nx, ny, nz] = BlockModel::DirectionToOffset(face.facingDirection);
+                    if (isCellSolid(x + nx, y + ny, z + nz))
+                        continue;
+
+                    AppendFace(opaque, face, i, blockType, x * scale, y * scale, z * scale, scale,
+                               CalculateFaceAmbientOcclusion(x, y, z, face, isCellSolid));
+                }
             }
         }
+    }
+}
+
+void Chunk::AssembleLodSkirts(const int scale, MeshBuffer& opaque) const
+{
+    // A neighbor meshed at another level has its own idea of where the surface along the shared border is, so cracks
+    // open up between the two meshes. Border faces hidden only by the neighbor's blocks are drawn anyway when they lie
+    // within two cells of the neighbor's surface, which covers the difference between two adjacent levels.
+    constexpr int skirtCells = 2;
+    const int cellsX = CHUNK_WIDTH / scale, cellsY = CHUNK_HEIGHT / scale, cellsZ = CHUNK_WIDTH / scale;
+    const auto isCellSolid = [&](const int x, const int y, const int z)
+    {
+        return scale == 1 ? IsOccludingAtLocal(x, y, z) : GetLodCellAtLocal(x, y, z, scale) != 0;
+    };
+
+    constexpr std::array seamDirections = {BlockModel::Direction::Forward, BlockModel::Direction::Backward, BlockModel::Direction::Left, BlockModel::Direction::Right};
+    for (const BlockModel::Direction direction : seamDirections)
+    {
+        if ((lodSeams & static_cast<int>(direction)) == 0)
+            continue;
 
-        const unsigned int faceCount = BlockType::Types[blockType].model.faces.size();
-        for (int i = 0; i < faceCount; i++)
+        const auto [nx, ny, nz] = BlockModel::DirectionToOffset(direction);
+        for (int along = 0; along < (nx != 0 ? cellsZ : cellsX); along++)
         {
-            // Check for occlusion
-            auto [globalX, globalY, globalZ] = LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-            const int worldCoordX = static_cast<int>(globalX);
-            const int worldCoordY = static_cast<int>(globalY);
-            const int worldCoordZ = static_cast<int>(globalZ);
-            if
-            (
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Right)       && !world->IsBlockAtCoordsTransparent(worldCoordX+1, worldCoordY, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Left)        && !world->IsBlockAtCoordsTransparent(worldCoordX-1, worldCoordY, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Up)          && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY+1, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Down)        && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY-1, worldCoordZ)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Forward)     && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY, worldCoordZ+1)) ||
-                (BlockType::Types[blockType].model.faces[i].occlusionNeighbors & static_cast<int>(BlockModel::Direction::Backward)    && !world->IsBlockAtCoordsTransparent(worldCoordX, worldCoordY, worldCoordZ-1))
-            )
+            const int x = nx != 0 ? (nx > 0 ? cellsX - 1 : 0) : along;
+            const int z = nz != 0 ? (nz > 0 ? cellsZ - 1 : 0) : along;
+            for (int y = 0; y < cellsY; y++)
             {
-                continue;
+                // Translucent blocks are in their own mesh, which has no skirts
+                const unsigned char blockType = scale == 1 ? this->data[x][y][z] : GetLodCell(x, y, z, scale);
+                if (blockType == 0 || BlockType::GetRenderPass(blockType) != BlockType::RenderPass::Opaque)
+                    continue;
+
+                // Faces into open cells are part of the mesh already, and faces deep inside the neighbor's ground can't show
+                if (!isCellSolid(x + nx, y, z + nz))
+                    continue;
+                bool nearSurface = false;
+                for (int above = 1; above <= skirtCells && !nearSurface; above++)
+                    nearSurface = !isCellSolid(x + nx, y + above, z + nz);
+                if (!nearSurface)
+                    continue;
+
+                const BlockModel::Model& model = BlockType::Types[blockType].model;
+                if (!opaque.Reserve(model.triangleCount))
+                    return;
+
+                for (int i = 0; i < model.faces.size(); i++)
+                {
+                    const BlockModel::BlockFace& face = model.faces[i];
+                    if (face.facingDirection == direction)
+                        AppendFace(opaque, face, i, blockType, x * scale, y * scale, z * scale, scale, CalculateFaceAmbientOcclusion(x, y, z, face, isCellSolid));
+                }
             }
+        }
+    }
+}
+
+template <>
+void Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::None>(int, int, int, unsigned int, MeshBuffer&, MeshBuffer&, std::vector<DecalInstance>&) const
+{
+    // Nothing to draw
+}
+
+template <>
+void Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::FullBlock>(const int x, const int y, const int z, const unsigned int blockType, MeshBuffer& opaque, MeshBuffer& transparent, std::vector<DecalInstance>&) const
+{
+    const BlockType::Type& type = BlockType::Types[blockType];
+    MeshBuffer& buffer = BlockType::GetRenderPass(blockType) == BlockType::RenderPass::Translucent ? transparent : opaque;
+
+    if (!buffer.Reserve(type.model.triangleCount))
+        return;
+
+    // Every full block face is culled by the one neighbor it faces. Most blocks are buried,
+    // so only gather the neighbors ambient occlusion needs once the visible faces are known.
+    int visibleFaces = 0;
+    for (int i = 0; i < type.model.faces.size(); i++)
+    {
+        const auto [nx, ny, nz] = BlockModel::DirectionToOffset(type.model.faces[i].facingDirection);
+        if (!IsOccludingAtLocal(x + nx, y + ny, z + nz))
+            visibleFaces |= 1 << i;
+    }
+    if (visibleFaces == 0)
+        return;
+
+    // Without ambient occlusion nothing occludes, and every corner comes out fully lit
+    const uint32_t occluding = ambientOcclusion.load(std::memory_order_relaxed) ? GetOcclusionNeighborhood(x, y, z, visibleFaces) : 0;
+
+    for (int i = 0; i < type.model.faces.size(); i++)
+    {
+        if ((visibleFaces & 1 << i) == 0)
+            continue;
 
-            for (auto & vertex : BlockType::Types[blockType].model.faces[i].vertices)
+        const BlockModel::BlockFace& face = type.model.faces[i];
+        AppendFace(buffer, face, i, blockType, x, y, z, 1, CalculateFullBlockFaceAmbientOcclusion(face.facingDirection, occluding));
+    }
+}
+
+template <>
+void Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::Decal>(const int x, const int y, const int z, const unsigned int blockType, MeshBuffer&, MeshBuffer&, std::vector<DecalInstance>& decals) const
+{
+    // Decals are never culled and stay fully lit, so all they need is a position and a texture
+    decals.push_back({static_cast<unsigned char>(x), static_cast<unsigned char>(y), static_cast<unsigned char>(z),
+                      static_cast<unsigned char>(BlockType::Types[blockType].textureIndices[0])});
+}
+
+const std::vector<Chunk::MeshKernel>& Chunk::GetMeshKernels()
+{
+    // One mesher path per block type, picked once from the kind of its model
+    static const std::vector<MeshKernel> kernels = []
+    {
+        std::vector<MeshKernel> result;
+        for (const auto& type : BlockType::Types)
+        {
+            switch (type.model.kind)
             {
-                opaqueVertices[opaqueVertexCount*3] = vertex[0] + x;
-                opaqueVertices[opaqueVertexCount*3 + 1] = vertex[1] + y;
-                opaqueVertices[opaqueVertexCount*3 + 2] = vertex[2] + z;
+                case BlockModel::Kind::FullBlock:
+                    result.push_back(&Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::FullBlock>);
+                    break;
+                case BlockModel::Kind::Decal:
+                    result.push_back(&Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::Decal>);
+                    break;
+                default:
+                    result.push_back(&Chunk::AssembleMeshPieceFromBlockModel<BlockModel::Kind::None>);
+                    break;
+            }
+        }
+        return result;
+    }();
+
+    return kernels;
+}
+
+std::vector<MeshRange> Chunk::GetVisibleOpaqueRanges(const Vector3 cameraPos) const
+{
+    const int visibleDirections = GetVisibleDirections(cameraPos, this->worldPosition,
+        Vector3Add(this->worldPosition, Vector3{CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_WIDTH}));
 
-                opaqueNormals[opaqueVertexCount*3] = vertex[3];
-                opaqueNormals[opaqueVertexCount*3 + 1] = vertex[4];
-                opaqueNormals[opaqueVertexCount*3 + 2] = vertex[5];
+    // Directionless faces are always drawn; neighboring ranges are merged into one draw
+    std::vector<MeshRange> result;
+    for (int i = 0; i < drawnOpaqueRanges.size(); i++)
+    {
+        const MeshRange& range = drawnOpaqueRanges[i];
+        if (range.vertexCount == 0 || (i < BlockModel::DirectionCount && !(visibleDirections & (1 << i))))
+            continue;
 
-                const auto [texX, texY] = BlockType::TransformTexcoordsToBlockmap(Vector2{vertex[6], vertex[7]}, i, blockType);
-                opaqueTexcoords[opaqueVertexCount*2] = texX;
-                opaqueTexcoords[opaqueVertexCount*2 + 1] = texY;
+        if (!result.empty() && result.back().firstVertex + result.back().vertexCount == range.firstVertex)
+            result.back().vertexCount += range.vertexCount;
+        else
+            result.push_back(range);
+    }
+
+    return result;
+}
 
-                opaqueVertexCount++;
+int Chunk::GetVisibleDirections(const Vector3 cameraPos, const Vector3 min, const Vector3 max)
+{
+    // A face can only be front-facing if the camera is on its outer side of its plane; every face plane
+    // lies inside the box, so comparing against the box is conservative
+    int result = 0;
+    if (cameraPos.z > min.z) result |= static_cast<int>(BlockModel::Direction::Forward);
+    if (cameraPos.z < max.z) result |= static_cast<int>(BlockModel::Direction::Backward);
+    if (cameraPos.x < max.x) result |= static_cast<int>(BlockModel::Direction::Left);
+    if (cameraPos.x > min.x) result |= static_cast<int>(BlockModel::Direction::Right);
+    if (cameraPos.y > min.y) result |= static_cast<int>(BlockModel::Direction::Up);
+    if (cameraPos.y < max.y) result |= static_cast<int>(BlockModel::Direction::Down);
+
+    return result;
+}
+
+bool ChunkMesh::AreFacesConnected(const int fromDirection, const int toDirection) const
+{
+    return faceConnectivity & (1ull << (fromDirection * BlockModel::DirectionCount + toDirection));
+}
+
+std::shared_ptr<const ChunkMesh> ChunkMesh::WithoutGeometry() const
+{
+    auto result = std::make_shared<ChunkMesh>(*this);
+    result->opaque = result->transparent = nullptr;
+    result->patchedRanges.clear();
+    return result;
+}
+
+uint64_t Chunk::ComputeFaceConnectivity() const
+{
+    constexpr int voxelCount = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH;
+    const unsigned char* blocks = this->data[0][0].data();
+
+    // Voxels light can pass through, as one flat array in data's [x][y][z] order
+    std::vector<unsigned char> open(voxelCount);
+    int openCount = 0;
+    for (int i = 0; i < voxelCount; i++)
+    {
+        open[i] = BlockType::Types[blocks[i]].isTransparent;
+        openCount += open[i];
+    }
+
+    // Chunks made of only air or only solid blocks (most of the sky and the deep underground) need no flood fill
+    if (openCount == 0 || openCount == voxelCount)
+        return openCount == 0 ? 0 : ChunkMesh::allFacesConnected;
+
+    // Flood fill every pocket of open voxels; all chunk faces one pocket touches can see each other.
+    // Visited voxels are closed off in place.
+    constexpr int strideX = CHUNK_HEIGHT * CHUNK_WIDTH, strideY = CHUNK_WIDTH;
+    constexpr int maxXZ = CHUNK_WIDTH - 1, maxY = CHUNK_HEIGHT - 1;
+    const std::array<int, BlockModel::DirectionCount> strides = [&]
+    {
+        std::array<int, BlockModel::DirectionCount> result {};
+        for (int direction = 0; direction < BlockModel::DirectionCount; direction++)
+        {
+            const auto [dx, dy, dz] = BlockModel::DirectionToOffset(static_cast<BlockModel::Direction>(1 << direction));
+            result[direction] = dx * strideX + dy * strideY + dz;
+        }
+        return result;
+    }();
+
+    std::vector<int> stack;
+    uint64_t faceConnectivity = 0;
+    for (int start = 0; start < voxelCount; start++)
+    {
+        if (!open[start])
+            continue;
+
+        const int startX = start / strideX, startY = start / strideY % CHUNK_HEIGHT, startZ = start % CHUNK_WIDTH;
+        int touchedFaces = (startZ == maxXZ) << 0 | (startZ == 0) << 1 | (startX == 0) << 2 |
+                           (startX == maxXZ) << 3 | (startY == maxY) << 4 | (startY == 0) << 5;
+        open[start] = false;
+        stack.push_back(start);
+        while (!stack.empty())
+        {
+            const int voxel = stack.back();
+            stack.pop_back();
+            const int x = voxel / strideX, y = voxel / strideY % CHUNK_HEIGHT, z = voxel % CHUNK_WIDTH;
+
+            // Per direction, how many steps the voxel is away from that face of the chunk
+            const std::array<int, BlockModel::DirectionCount> toBorder = {
+                maxXZ - z, z, x, maxXZ - x, maxY - y, y};
+
+            for (int direction = 0; direction < BlockModel::DirectionCount; direction++)
+            {
+                if (toBorder[direction] == 0)
+                    continue;
+
+                // Faces are counted as soon as a voxel is queued so the early exit below triggers without draining the stack
+                const int neighbor = voxel + strides[direction];
+                if (open[neighbor])
+                {
+                    open[neighbor] = false;
+                    stack.push_back(neighbor);
+                    if (toBorder[direction] == 1)
+                        touchedFaces |= 1 << direction;
+                }
             }
-            opaqueTriangleCount += BlockType::Types[blockType].model.faces[i].triangleCount;
+
+            // A pocket reaching every face connects all of them, whatever the rest of the chunk holds
+            if (touchedFaces == (1 << BlockModel::DirectionCount) - 1)
+                return ChunkMesh::allFacesConnected;
         }
+
+        for (int from = 0; from < BlockModel::DirectionCount; from++)
+        {
+            if (touchedFaces & (1 << from))
+                faceConnectivity |= static_cast<uint64_t>(touchedFaces) << (from * BlockModel::DirectionCount);
+        }
+
+        // Nothing more to learn once every face reaches every other one
+        if (faceConnectivity == ChunkMesh::allFacesConnected)
+            return faceConnectivity;
+    }
+
+    return faceConnectivity;
+}
+
+void Chunk::ComputeColumnSummaries()
+{
+    for (int x = 0; x < CHUNK_WIDTH; x++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+            ComputeColumnSummary(x, z);
+    }
+}
+
+void Chunk::ComputeColumnSummary(const int x, const int z)
+{
+    ColumnSummary& summary = columnSummaries[x * CHUNK_WIDTH + z];
+    summary = {};
+
+    int y = CHUNK_HEIGHT - 1;
+    while (y >= 0 && BlockType::Types[data[x][y][z]].isTransparent)
+        y--;
+    if (y < 0)
+        return;
+
+    summary.top = static_cast<signed char>(y);
+    while (y >= 0 && !BlockType::Types[data[x][y][z]].isTransparent)
+    {
+        summary.run++;
+        y--;
     }
 }
 
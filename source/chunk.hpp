@@ -1,33 +1,186 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <sstream>
+#include <vector>
 
+#include "hopscotch_map.h"
 #include "blockmodel.hpp"
+#include "decalrenderer.hpp"
 #include "global.hpp"
+#include "gpureleasequeue.hpp"
+#include "meshdrawing.hpp"
+#include "vertexarena.hpp"
 
 class World;
 
+// Maps voxel index * BlockModel::DirectionCount + direction index to the first vertex of that face in a mesh
+using FaceSlotMap = tsl::hopscotch_map<int, int>;
+
+// Growable CPU-side vertex buffer the mesher writes into; ownership of the arrays passes to the Mesh
+struct MeshBuffer
+{
+    int triangleCount = 0, maxTriangleCount = 0, vertexCount = 0;
+    float* vertices = nullptr;
+    float* normals = nullptr;
+    float* texcoords = nullptr;
+    unsigned char* colors = nullptr;
+
+    struct FaceRecord
+    {
+        unsigned char direction = 0; // BlockModel::DirectionToIndex of the face
+        int vertexCount = 0;
+        int voxel = -1;             // Index of the block in the chunk, -1 for downsampled cells
+    };
+
+    // Every appended face, in order
+    std::vector<FaceRecord> faces;
+
+    // Bytes requested for vertex arrays by all mesh buffers so far, read by the meshing benchmark
+    static inline std::atomic<size_t> allocatedBytes = 0;
+
+    explicit MeshBuffer(int initialTriangleCount);
+
+    bool Reserve(int additionalTriangleCount);
+    [[nodiscard]] std::array<MeshRange, BlockModel::DirectionCount + 1> GroupFacesByDirection(int spareVerticesPerDirection = 0, FaceSlotMap* faceSlots = nullptr);
+    [[nodiscard]] Mesh ToMesh() const;
+    void Free();
+};
+
+// CPU arrays of one mesh. Freed without touching the GPU, so the last owner can drop it on any thread.
+struct CpuMesh
+{
+    Mesh mesh {};
+
+    explicit CpuMesh(const Mesh& mesh);
+    CpuMesh(const CpuMesh&) = delete;
+    CpuMesh& operator=(const CpuMesh&) = delete;
+    ~CpuMesh();
+
+    [[nodiscard]] std::shared_ptr<CpuMesh> Copy() const;
+
+    // Vertex data held by every CpuMesh alive, for memory accounting
+    static inline std::atomic<size_t> residentBytes = 0;
+    [[nodiscard]] static size_t GetByteSize(const Mesh& mesh);
+};
+
+// One build of a chunk's meshes. Immutable once published, so the simulation can build the next one
+// while the renderer is still uploading and drawing this one.
+struct ChunkMesh
+{
+    static inline std::atomic<uint64_t> nextId = 1;
+    uint64_t id = nextId++;    // Copies keep it, so a build stays recognizable once its geometry is freed
+    uint64_t transparentId = id; // Build the transparent mesh was made in, patches share their base's
+
+    std::shared_ptr<const CpuMesh> opaque, transparent; // nullptr once freed after upload
+    std::array<MeshRange, BlockModel::DirectionCount + 1> opaqueRanges {}; // Opaque vertices per facing direction, directionless last
+    std::shared_ptr<const std::vector<DecalInstance>> decals; // Decal blocks of a full resolution mesh, drawn instanced instead of baked into transparent
+
+    static constexpr uint64_t allFacesConnected = (1ull << BlockModel::DirectionCount * BlockModel::DirectionCount) - 1;
+    uint64_t faceConnectivity = allFacesConnected; // Bit from * DirectionCount + to
+
+    // Set to the id of another build when this one only rewrote a few vertices of its opaque mesh, which can then be patched on the GPU
+    uint64_t patchedFrom = 0;
+    std::vector<MeshRange> patchedRanges;
+
+    // Whether the chunk faces in the two directions (BlockModel direction indices) are connected through non-opaque blocks
+    [[nodiscard]] bool AreFacesConnected(int fromDirection, int toDirection) const;
+
+    [[nodiscard]] bool HasGeometry() const { return opaque != nullptr; }
+    // The same build with only what drawing and culling need, vertex data stays with the GPU
+    [[nodiscard]] std::shared_ptr<const ChunkMesh> WithoutGeometry() const;
+};
+
+// Render thread objects that chunks upload their meshes into
+struct ChunkGpuContext
+{
+    VertexArena& opaqueArena;
+    const DecalRenderer& decalRenderer;
+    GpuReleaseQueue& releaseQueue;
+};
+
 class Chunk {
     public:
+        // Highest opaque block of one block column and how many opaque blocks run down from it, -1 and 0 without any
+        struct ColumnSummary
+        {
+            signed char top = -1;
+            unsigned char run = 0;
+        };
+
         Chunk(World* world, Vector3 pos);
         ~Chunk();
 
-        void GenerateChunkMesh();
-        void UploadChunkMesh();
+        void GenerateChunkMesh(int lodLevel = 0, int lodSeams = 0);
+        // Render thread only; returns false if the arena is out of room for the opaque mesh
+        bool UploadChunkMesh(ChunkGpuContext& gpu, const std::shared_ptr<const ChunkMesh>& build);
+        [[nodiscard]] bool NeedsUpload(const std::shared_ptr<const ChunkMesh>& build, const VertexArena& arena) const;
+        [[nodiscard]] size_t GetUploadByteSize(const ChunkMesh& build) const;
+        bool PatchBlockFaces(int editX, int editY, int editZ);
+        // Simulation side; drops the CPU copy of a build the renderer has uploaded, edits then rebuild the whole mesh
+        void FreeUploadedGeometry();
         [[nodiscard]] Vector3 LocalToGlobalPos(Vector3 in) const;
+        [[nodiscard]] std::vector<MeshRange> GetVisibleOpaqueRanges(Vector3 cameraPos) const;
+
+        // Bitmask of face directions that can face a camera at cameraPos, for faces inside the box (min, max)
+        [[nodiscard]] static int GetVisibleDirections(Vector3 cameraPos, Vector3 min, Vector3 max);
+
+        [[nodiscard]] uint64_t ComputeFaceConnectivity() const;
+        void ComputeColumnSummaries();
+
+        // Bake corner ambient occlusion into vertex colors, off leaves every vertex fully lit (for measuring its cost)
+        static inline std::atomic<bool> ambientOcclusion = true;
 
         Vector3 position, worldPosition;
-        std::array<std::array<std::array<int, CHUNK_WIDTH>, CHUNK_HEIGHT>, CHUNK_WIDTH> data {};
-        Mesh opaqueMesh {};
-        Mesh transparentMesh {};
+        std::array<std::array<std::array<unsigned char, CHUNK_WIDTH>, CHUNK_HEIGHT>, CHUNK_WIDTH> data {}; // Block types, a byte each
+
+        // Simulation side: the latest build, nullptr until the chunk is first meshed
+        std::shared_ptr<const ChunkMesh> mesh;
+        std::array<ColumnSummary, CHUNK_WIDTH * CHUNK_WIDTH> columnSummaries {}; // Indexed x * CHUNK_WIDTH + z, updated along with the mesh
+        int lodLevel = 0; // Mesh is built from blocks downsampled by 2^lodLevel on every axis
+        int meshNeighborMask = 0; // Face neighbors (BlockModel::Direction bits) that held data when the mesh was built
+        int lodSeams = 0; // Horizontal face neighbors (BlockModel::Direction bits) meshed at another level, skirted along their border
+        bool unsaved = false; // Block data differs from the region file, set when generated or edited
 
-        bool validMesh = false;
-        bool reuploadMeshFlag = false;
+        // Render side: the build on the GPU without its geometry, drawn until a newer one is uploaded
+        std::shared_ptr<const ChunkMesh> uploadedMesh;
+        std::atomic<uint64_t> uploadedMeshId = 0; // Read by the simulation to tell when a build's geometry can go
+        std::atomic<bool> geometryLost = false;   // Set when the GPU copy is gone too, the simulation builds the mesh again
+        VertexArena::Allocation opaqueAllocation;
+        std::array<MeshRange, BlockModel::DirectionCount + 1> drawnOpaqueRanges {};
+        Mesh transparentGpuMesh {}; // Vertex array and buffers only, no CPU arrays
+        DecalBatch decals;
     private:
+        using MeshKernel = void (Chunk::*)(int, int, int, unsigned int, MeshBuffer&, MeshBuffer&, std::vector<DecalInstance>&) const;
+
         World* world;
+        ChunkGpuContext* gpu = nullptr; // Where the render side lives, once uploaded
+
+        // Where every opaque face of a full resolution mesh lives, and which slots were freed by edits
+        FaceSlotMap opaqueFaceSlots;
+        std::array<std::vector<int>, BlockModel::DirectionCount> freeFaceSlots;
+
+        [[nodiscard]] static const std::vector<MeshKernel>& GetMeshKernels();
+
+        void ReleaseGpuResources();
+        void ComputeColumnSummary(int x, int z);
+
+        static void WriteOpaqueFaceSlot(Mesh& opaque, int firstVertex, const MeshBuffer& face);
+        static void ClearOpaqueFaceSlot(Mesh& opaque, int firstVertex, int vertexCount);
+
+        [[nodiscard]] unsigned char GetBlockAtLocal(int x, int y, int z) const;
+        [[nodiscard]] bool IsOccludingAtLocal(int x, int y, int z) const;
+        // Bitmask of which blocks in front of the visible faces (bit per BlockModel::FullBlock face) of (x, y, z) occlude,
+        // bit ((dx + 1) * 3 + dy + 1) * 3 + dz + 1 for the block at (x + dx, y + dy, z + dz)
+        [[nodiscard]] uint32_t GetOcclusionNeighborhood(int x, int y, int z, int visibleFaces) const;
+        [[nodiscard]] unsigned char GetLodCell(int cellX, int cellY, int cellZ, int scale) const;
+        [[nodiscard]] unsigned char GetLodCellAtLocal(int cellX, int cellY, int cellZ, int scale) const;
 
-        void AssembleMeshPieceFromBlockModel(int x, int y, int z, unsigned int blockType,
-                                             int& opaqueTriangleCount, int& maxOpaqueTriangleCount, int& opaqueVertexCount, float* &opaqueVertices, float* &opaqueNormals, float* &opaqueTexcoords,
-                                             int& transparentTriangleCount, int& maxTransparentTriangleCount, int& transparentVertexCount, float* &transparentVertices, float* &transparentNormals, float* &transparentTexcoords) const;
+        template <BlockModel::Kind kind>
+        void AssembleMeshPieceFromBlockModel(int x, int y, int z, unsigned int blockType, MeshBuffer& opaque, MeshBuffer& transparent, std::vector<DecalInstance>& decals) const;
+        void AssembleLodMesh(int scale, MeshBuffer& opaque) const;
+        void AssembleLodSkirts(int scale, MeshBuffer& opaque) const;
 };
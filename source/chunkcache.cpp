@@ -0,0 +1,177 @@
+#include "chunkcache.hpp"
+
+#include <cstring>
+
+#include "chunkcodec.hpp"
+
+ChunkCache::ChunkCache(const size_t maxBytes) : maxBytes(maxBytes)
+{}
+
+void ChunkCache::Store(const Chunk& chunk)
+{
+    Entry entry;
+    entry.key = GetGridKey(chunk.position);
+
+    entry.data = ChunkCodec::Encode(chunk);
+
+    // Only meshes that still have their geometry on the CPU side can be kept, the rest is built again from the block data.
+    // Edits rebuild or patch the mesh right away, so a mesh always matches the chunk's own blocks; the neighbors'
+    // blocks it was built against are guarded by InvalidateMesh.
+    entry.hasMesh = chunk.mesh != nullptr && chunk.mesh->HasGeometry();
+    if (entry.hasMesh)
+    {
+        entry.lodLevel = chunk.lodLevel;
+        entry.meshNeighborMask = chunk.meshNeighborMask;
+        entry.lodSeams = chunk.lodSeams;
+        entry.faceConnectivity = chunk.mesh->faceConnectivity;
+        entry.columnSummaries = chunk.columnSummaries;
+        entry.opaqueMesh = CopyMesh(chunk.mesh->opaque->mesh);
+        entry.opaqueRanges = chunk.mesh->opaqueRanges;
+        entry.transparentMesh = CopyMesh(chunk.mesh->transparent->mesh);
+        entry.decals = *chunk.mesh->decals;
+    }
+
+    std::lock_guard lock(mutex);
+
+    if (const auto it = lookup.find(entry.key); it != lookup.end())
+    {
+        stats.bytes -= it->second->GetByteSize();
+        entries.erase(it->second);
+        lookup.erase(it);
+    }
+
+    stats.bytes += entry.GetByteSize();
+    entries.push_front(std::move(entry));
+    lookup[entries.front().key] = entries.begin();
+
+    Evict();
+}
+
+bool ChunkCache::Restore(Chunk& chunk)
+{
+    std::unique_lock lock(mutex);
+
+    const auto it = lookup.find(GetGridKey(chunk.position));
+    if (it == lookup.end())
+    {
+        stats.misses++;
+        return false;
+    }
+
+    // Take the entry out of the cache, the chunk owns it from now on
+    Entry entry = std::move(*it->second);
+    stats.bytes -= entry.GetByteSize();
+    entries.erase(it->second);
+    lookup.erase(it);
+    lock.unlock();
+
+    ChunkCodec::Decode(entry.data.data(), entry.data.size(), chunk);
+
+    if (entry.hasMesh)
+    {
+        auto mesh = std::make_shared<ChunkMesh>();
+        mesh->opaque = std::make_shared<const CpuMesh>(RestoreMesh(entry.opaqueMesh));
+        mesh->opaqueRanges = entry.opaqueRanges;
+        mesh->transparent = std::make_shared<const CpuMesh>(RestoreMesh(entry.transparentMesh));
+        mesh->decals = std::make_shared<const std::vector<DecalInstance>>(std::move(entry.decals));
+        mesh->faceConnectivity = entry.faceConnectivity;
+        chunk.mesh = std::move(mesh);
+        chunk.lodLevel = entry.lodLevel;
+        chunk.meshNeighborMask = entry.meshNeighborMask;
+        chunk.lodSeams = entry.lodSeams;
+        chunk.columnSummaries = entry.columnSummaries;
+    }
+
+    lock.lock();
+    stats.hits++;
+    if (entry.hasMesh)
+        stats.meshHits++;
+
+    return true;
+}
+
+void ChunkCache::InvalidateMesh(const Vector3 chunkPos)
+{
+    std::lock_guard lock(mutex);
+
+    const auto it = lookup.find(GetGridKey(chunkPos));
+    if (it == lookup.end() || !it->second->hasMesh)
+        return;
+
+    Entry& entry = *it->second;
+    stats.bytes -= entry.GetByteSize();
+    entry.hasMesh = false;
+    entry.opaqueMesh = {};
+    entry.transparentMesh = {};
+    entry.decals = {};
+    stats.bytes += entry.GetByteSize();
+    stats.staleMeshes++;
+}
+
+ChunkCache::Stats ChunkCache::GetStats() const
+{
+    std::lock_guard lock(mutex);
+
+    Stats result = stats;
+    result.entries = entries.size();
+    return result;
+}
+
+size_t ChunkCache::CachedMesh::GetByteSize() const
+{
+    return vertices.size() * sizeof(float) + normals.size() * sizeof(float) + texcoords.size() * sizeof(float) + colors.size();
+}
+
+size_t ChunkCache::Entry::GetByteSize() const
+{
+    return sizeof(Entry) + data.size() + opaqueMesh.GetByteSize() + transparentMesh.GetByteSize() + decals.size() * sizeof(DecalInstance);
+}
+
+ChunkCache::CachedMesh ChunkCache::CopyMesh(const Mesh& mesh)
+{
+    // Copy exactly vertexCount vertices, not the mesher's oversized buffers
+    CachedMesh result;
+    result.triangleCount = mesh.triangleCount;
+    result.vertexCount = mesh.vertexCount;
+    if (mesh.vertexCount == 0)
+        return result;
+
+    result.vertices.assign(mesh.vertices, mesh.vertices + mesh.vertexCount * 3);
+    result.normals.assign(mesh.normals, mesh.normals + mesh.vertexCount * 3);
+    result.texcoords.assign(mesh.texcoords, mesh.texcoords + mesh.vertexCount * 2);
+    result.colors.assign(mesh.colors, mesh.colors + mesh.vertexCount * 4);
+
+    return result;
+}
+
+Mesh ChunkCache::RestoreMesh(const CachedMesh& cached)
+{
+    Mesh result{};
+    result.triangleCount = cached.triangleCount;
+    result.vertexCount = cached.vertexCount;
+    if (cached.vertexCount == 0)
+        return result;
+
+    result.vertices = static_cast<float*>(MemAlloc(cached.vertices.size() * sizeof(float)));
+    result.normals = static_cast<float*>(MemAlloc(cached.normals.size() * sizeof(float)));
+    result.texcoords = static_cast<float*>(MemAlloc(cached.texcoords.size() * sizeof(float)));
+    result.colors = static_cast<unsigned char*>(MemAlloc(cached.colors.size()));
+    std::memcpy(result.vertices, cached.vertices.data(), cached.vertices.size() * sizeof(float));
+    std::memcpy(result.normals, cached.normals.data(), cached.normals.size() * sizeof(float));
+    std::memcpy(result.texcoords, cached.texcoords.data(), cached.texcoords.size() * sizeof(float));
+    std::memcpy(result.colors, cached.colors.data(), cached.colors.size());
+
+    return result;
+}
+
+void ChunkCache::Evict()
+{
+    // Drop least recently stored chunks until we fit the budget again
+    while (stats.bytes > maxBytes && !entries.empty())
+    {
+        stats.bytes -= entries.back().GetByteSize();
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+}
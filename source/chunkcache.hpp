@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "hopscotch_map.h"
+#include "chunk.hpp"
+
+// Memory-bounded LRU cache of block data and CPU-side meshes for recently unloaded chunks,
+// so walking back into an area only costs a GPU upload instead of generation and meshing
+class ChunkCache
+{
+    public:
+        struct Stats
+        {
+            unsigned long hits = 0;         // Block data restored
+            unsigned long meshHits = 0;     // ...along with its mesh
+            unsigned long staleMeshes = 0;  // Cached meshes dropped because a neighboring chunk changed
+            unsigned long misses = 0;
+            unsigned long evictions = 0;
+            size_t bytes = 0;
+            size_t entries = 0;
+        };
+
+        explicit ChunkCache(size_t maxBytes);
+
+        void Store(const Chunk& chunk);
+        bool Restore(Chunk& chunk);
+        // Drops the mesh of a cached chunk, keeping its block data; for when a neighbor's blocks changed under it
+        void InvalidateMesh(Vector3 chunkPos);
+
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        struct CachedMesh
+        {
+            int triangleCount = 0, vertexCount = 0;
+            std::vector<float> vertices, normals, texcoords;
+            std::vector<unsigned char> colors;
+
+            [[nodiscard]] size_t GetByteSize() const;
+        };
+
+        struct Entry
+        {
+            uint64_t key = 0;
+            std::vector<unsigned char> data; // Encoded by ChunkCodec, generated terrain mostly in under a KB
+            int lodLevel = 0;
+            int meshNeighborMask = 0;
+            int lodSeams = 0;
+            uint64_t faceConnectivity = 0;
+            std::array<Chunk::ColumnSummary, CHUNK_WIDTH * CHUNK_WIDTH> columnSummaries {};
+            bool hasMesh = false;
+            CachedMesh opaqueMesh, transparentMesh;
+            std::vector<DecalInstance> decals;
+            std::array<MeshRange, BlockModel::DirectionCount + 1> opaqueRanges {};
+
+            [[nodiscard]] size_t GetByteSize() const;
+        };
+
+        static CachedMesh CopyMesh(const Mesh& mesh);
+        static Mesh RestoreMesh(const CachedMesh& cached);
+
+        void Evict();
+
+        size_t maxBytes;
+        Stats stats;
+
+        std::list<Entry> entries; // Most recently stored first
+        tsl::hopscotch_map<uint64_t, std::list<Entry>::iterator> lookup;
+        mutable std::mutex mutex;
+};
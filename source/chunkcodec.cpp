@@ -0,0 +1,390 @@
+#include "chunkcodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "blocktype.hpp"
+
+namespace ChunkCodec
+{
+    // The first byte of every blob
+    static constexpr unsigned char formatPacked = 1;
+    static constexpr unsigned char formatRuns = 2;
+    static constexpr unsigned char formatRunsLz = 3;
+
+    static constexpr int blockCount = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH;
+    // A run is at most a varint of 23 bits, four bytes
+    static constexpr size_t maxRunBytes = blockCount * 4;
+
+    // Back references are at least minMatch bytes long and reach at most maxOffset bytes back
+    static constexpr int minMatch = 4;
+    static constexpr size_t maxOffset = 0xFFFF;
+    static constexpr int hashBits = 12;
+
+    struct Palette
+    {
+        std::array<int, 256> index;         // By block type, -1 if the chunk doesn't use it
+        std::vector<unsigned char> entries;
+    };
+
+    // Block types fit in a byte, so the palette never has more than 256 entries
+    static Palette MakePalette(const Chunk& chunk)
+    {
+        Palette palette;
+        palette.index.fill(-1);
+        for (const auto& x : chunk.data)
+        {
+            for (const auto& y : x)
+            {
+                for (const unsigned char block : y)
+                {
+                    int& index = palette.index[block];
+                    if (index == -1)
+                    {
+                        index = static_cast<int>(palette.entries.size());
+                        palette.entries.push_back(block);
+                    }
+                }
+            }
+        }
+
+        return palette;
+    }
+
+    // Bits per palette index; a single entry palette needs none at all
+    static int GetIndexBits(const int paletteSize)
+    {
+        return std::bit_width(static_cast<unsigned int>(paletteSize - 1));
+    }
+
+    static void PutVarint(std::vector<unsigned char>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    static bool GetVarint(const unsigned char*& in, const unsigned char* end, uint32_t& value)
+    {
+        // Almost every run fits in one byte
+        if (in < end && *in < 0x80)
+        {
+            value = *in++;
+            return true;
+        }
+
+        value = 0;
+        for (int shift = 0; shift < 32 && in < end; shift += 7)
+        {
+            const unsigned char byte = *in++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (byte < 0x80)
+                return true;
+        }
+
+        return false;
+    }
+
+    static void EncodePacked(const Chunk& chunk, const Palette& palette, std::vector<unsigned char>& blob)
+    {
+        const int bits = GetIndexBits(static_cast<int>(palette.entries.size()));
+        blob.reserve(blob.size() + (blockCount * bits + 7) / 8);
+        if (bits == 0)
+            return;
+
+        // Indices in data order, least significant bits first
+        uint64_t pending = 0;
+        int pendingBits = 0;
+        for (const auto& x : chunk.data)
+        {
+            for (const auto& y : x)
+            {
+                for (const unsigned char block : y)
+                {
+                    pending |= static_cast<uint64_t>(palette.index[block]) << pendingBits;
+                    pendingBits += bits;
+                    while (pendingBits >= 8)
+                    {
+                        blob.push_back(static_cast<unsigned char>(pending));
+                        pending >>= 8;
+                        pendingBits -= 8;
+                    }
+                }
+            }
+        }
+        if (pendingBits > 0)
+            blob.push_back(static_cast<unsigned char>(pending));
+    }
+
+    // Every run is one varint, its length minus one above the palette index. Runs follow the data order and carry on
+    // across rows, so the uniform layers above and below the surface are a run each; walking y columns instead starts
+    // new runs at every layer of every column and comes out more than twice as large on surface chunks.
+    static void EncodeRuns(const Chunk& chunk, const Palette& palette, std::vector<unsigned char>& out)
+    {
+        const int bits = GetIndexBits(static_cast<int>(palette.entries.size()));
+        int current = -1;
+        uint32_t length = 0;
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            for (int y = 0; y < CHUNK_HEIGHT; y++)
+            {
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                {
+                    const int index = palette.index[chunk.data[x][y][z]];
+                    if (index == current)
+                    {
+                        length++;
+                        continue;
+                    }
+
+                    if (length > 0)
+                        PutVarint(out, (length - 1) << bits | current);
+                    current = index;
+                    length = 1;
+                }
+            }
+        }
+        PutVarint(out, (length - 1) << bits | current);
+    }
+
+    // Sequences of a token byte with the literal count and match length in its two nibbles, the overflow of either
+    // as a varint, the literals, then a two byte offset back to the match. The last sequence stops after its literals.
+    static void PutSequence(std::vector<unsigned char>& out, const unsigned char* literals, const size_t literalCount,
+                            const size_t offset, const size_t matchLength)
+    {
+        const size_t matchCode = matchLength > 0 ? matchLength - minMatch : 0;
+        out.push_back(static_cast<unsigned char>(std::min<size_t>(literalCount, 15) << 4 | std::min<size_t>(matchCode, 15)));
+        if (literalCount >= 15)
+            PutVarint(out, static_cast<uint32_t>(literalCount - 15));
+        out.insert(out.end(), literals, literals + literalCount);
+        if (matchLength == 0)
+            return;
+
+        out.push_back(static_cast<unsigned char>(offset));
+        out.push_back(static_cast<unsigned char>(offset >> 8));
+        if (matchCode >= 15)
+            PutVarint(out, static_cast<uint32_t>(matchCode - 15));
+    }
+
+    // Greedy, with the last position of every hashed four bytes as the only match candidate
+    static void CompressLz(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+    {
+        std::array<int, 1 << hashBits> lastSeen;
+        lastSeen.fill(-1);
+
+        size_t literalStart = 0;
+        size_t i = 0;
+        while (i + minMatch <= in.size())
+        {
+            uint32_t sequence;
+            std::memcpy(&sequence, in.data() + i, sizeof(sequence));
+            int& slot = lastSeen[sequence * 2654435761u >> (32 - hashBits)];
+            const int candidate = slot;
+            slot = static_cast<int>(i);
+            if (candidate < 0 || i - candidate > maxOffset || std::memcmp(in.data() + candidate, in.data() + i, minMatch) != 0)
+            {
+                i++;
+                continue;
+            }
+
+            size_t length = minMatch;
+            while (i + length < in.size() && in[candidate + length] == in[i + length])
+                length++;
+
+            PutSequence(out, in.data() + literalStart, i - literalStart, i - candidate, length);
+            i += length;
+            literalStart = i;
+        }
+
+        PutSequence(out, in.data() + literalStart, in.size() - literalStart, 0, 0);
+    }
+
+    static bool DecompressLz(const unsigned char* in, const unsigned char* end, unsigned char* out, const size_t size)
+    {
+        unsigned char* const start = out;
+        unsigned char* const outEnd = out + size;
+        while (in < end)
+        {
+            const unsigned char token = *in++;
+
+            uint64_t literalCount = token >> 4;
+            uint32_t extra = 0;
+            if (literalCount == 15 && !GetVarint(in, end, extra))
+                return false;
+            literalCount += extra;
+            if (literalCount > static_cast<uint64_t>(end - in) || literalCount > static_cast<uint64_t>(outEnd - out))
+                return false;
+            std::memcpy(out, in, literalCount);
+            in += literalCount;
+            out += literalCount;
+            if (in == end)
+                break;
+
+            if (end - in < 2)
+                return false;
+            const size_t offset = in[0] | in[1] << 8;
+            in += 2;
+            uint64_t length = (token & 15) + minMatch;
+            extra = 0;
+            if ((token & 15) == 15 && !GetVarint(in, end, extra))
+                return false;
+            length += extra;
+            if (offset == 0 || offset > static_cast<size_t>(out - start) || length > static_cast<uint64_t>(outEnd - out))
+                return false;
+
+            // Matches closer than their length repeat bytes they write themselves
+            const unsigned char* match = out - offset;
+            if (offset >= length)
+                std::memcpy(out, match, length);
+            else
+                for (uint64_t i = 0; i < length; i++)
+                    out[i] = match[i];
+            out += length;
+        }
+
+        return out == outEnd;
+    }
+
+    static bool DecodePacked(const unsigned char* packed, const size_t size, const unsigned char* palette, const int paletteSize, Chunk& chunk)
+    {
+        const int bits = GetIndexBits(paletteSize);
+        if (size != static_cast<size_t>(blockCount * bits + 7) / 8)
+            return false;
+
+        const uint64_t mask = (1ull << bits) - 1;
+        uint64_t pending = 0;
+        int pendingBits = 0;
+        for (auto& x : chunk.data)
+        {
+            for (auto& y : x)
+            {
+                for (unsigned char& block : y)
+                {
+                    while (pendingBits < bits)
+                    {
+                        pending |= static_cast<uint64_t>(*packed++) << pendingBits;
+                        pendingBits += 8;
+                    }
+
+                    const auto index = static_cast<int>(pending & mask);
+                    if (index >= paletteSize)
+                        return false;
+                    block = palette[index];
+                    pending >>= bits;
+                    pendingBits -= bits;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static bool DecodeRuns(const unsigned char* in, const unsigned char* end, const unsigned char* palette, const int paletteSize, Chunk& chunk)
+    {
+        // Blocks are a byte each in data order, so every run is a single memset straight into the chunk
+        static_assert(sizeof(chunk.data) == blockCount);
+        unsigned char* blocks = chunk.data[0][0].data();
+        const int bits = GetIndexBits(paletteSize);
+        const uint32_t mask = (1u << bits) - 1;
+        uint32_t filled = 0;
+        while (in < end)
+        {
+            uint32_t run;
+            if (!GetVarint(in, end, run))
+                return false;
+
+            const uint32_t index = run & mask;
+            const uint32_t length = (run >> bits) + 1;
+            if (index >= static_cast<uint32_t>(paletteSize) || length > blockCount - filled)
+                return false;
+
+            std::memset(blocks + filled, palette[index], length);
+            filled += length;
+        }
+        return filled == blockCount;
+    }
+
+    std::vector<unsigned char> Encode(const Chunk& chunk, const Format format)
+    {
+        const Palette palette = MakePalette(chunk);
+
+        std::vector<unsigned char> blob;
+        blob.reserve(2 + palette.entries.size());
+        blob.push_back(format == Format::Packed ? formatPacked : formatRuns);
+        blob.push_back(static_cast<unsigned char>(palette.entries.size() - 1));
+        blob.insert(blob.end(), palette.entries.begin(), palette.entries.end());
+
+        if (format == Format::Packed)
+        {
+            EncodePacked(chunk, palette, blob);
+            return blob;
+        }
+
+        if (format == Format::Runs)
+        {
+            EncodeRuns(chunk, palette, blob);
+            return blob;
+        }
+
+        std::vector<unsigned char> runs;
+        EncodeRuns(chunk, palette, runs);
+        std::vector<unsigned char> compressed;
+        PutVarint(compressed, static_cast<uint32_t>(runs.size()));
+        CompressLz(runs, compressed);
+
+        // Chunks without much repetition between their columns stay plain runs
+        if (compressed.size() < runs.size())
+        {
+            blob[0] = formatRunsLz;
+            blob.insert(blob.end(), compressed.begin(), compressed.end());
+        }
+        else
+        {
+            blob.insert(blob.end(), runs.begin(), runs.end());
+        }
+
+        return blob;
+    }
+
+    bool Decode(const unsigned char* blob, const size_t size, Chunk& chunk)
+    {
+        if (size < 2)
+            return false;
+
+        const int paletteSize = blob[1] + 1;
+        const unsigned char* palette = blob + 2;
+        if (size < 2 + static_cast<size_t>(paletteSize))
+            return false;
+
+        // A damaged palette would hand the mesher block types that don't exist
+        if (std::any_of(palette, palette + paletteSize, [](const unsigned char blockType) { return blockType >= BlockType::Types.size(); }))
+            return false;
+
+        const unsigned char* data = palette + paletteSize;
+        const unsigned char* end = blob + size;
+        switch (blob[0])
+        {
+            case formatPacked:
+                return DecodePacked(data, end - data, palette, paletteSize, chunk);
+            case formatRuns:
+                return DecodeRuns(data, end, palette, paletteSize, chunk);
+            case formatRunsLz:
+            {
+                uint32_t runBytes;
+                if (!GetVarint(data, end, runBytes) || runBytes == 0 || runBytes > maxRunBytes)
+                    return false;
+
+                std::vector<unsigned char> runs(runBytes);
+                return DecompressLz(data, end, runs.data(), runs.size()) && DecodeRuns(runs.data(), runs.data() + runs.size(), palette, paletteSize, chunk);
+            }
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "chunk.hpp"
+
+// Compact blobs of a chunk's block data, as stored in region files and the chunk cache. Every format starts with a
+// format byte and a palette of the block types the chunk uses, blocks are stored as indices into it.
+namespace ChunkCodec
+{
+    enum class Format
+    {
+        Packed, // One index per block, packed into as few bits as the palette needs
+        Runs,   // Runs of one index as varints, in data order; terrain is layered, so most rows of a chunk are one block
+        RunsLz, // The runs with repeated byte sequences replaced by back references, if that makes them smaller
+    };
+
+    [[nodiscard]] std::vector<unsigned char> Encode(const Chunk& chunk, Format format = Format::RunsLz);
+    // Reads any of the formats; fills in the chunk's block data, false if the blob is malformed, the chunk is left
+    // partly written then
+    bool Decode(const unsigned char* blob, size_t size, Chunk& chunk);
+}
@@ -0,0 +1,114 @@
+#include "chunkfixtures.hpp"
+
+#include "PerlinNoise.hpp"
+
+namespace ChunkFixtures
+{
+    static void FillAllAir(Chunk& chunk)
+    {
+        for (auto& plane : chunk.data)
+            for (auto& row : plane)
+                row.fill(0);
+    }
+
+    static void FillAllStone(Chunk& chunk)
+    {
+        for (auto& plane : chunk.data)
+            for (auto& row : plane)
+                row.fill(4);
+    }
+
+    static void FillFlatPlane(Chunk& chunk)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+            for (int y = 0; y < CHUNK_HEIGHT / 2; y++)
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                    chunk.data[x][y][z] = y == CHUNK_HEIGHT / 2 - 1 ? 1 : 4;
+    }
+
+    static void FillNoiseCaves(Chunk& chunk)
+    {
+        const siv::PerlinNoise perlin{ 12345 };
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+            for (int y = 0; y < CHUNK_HEIGHT; y++)
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                    chunk.data[x][y][z] = perlin.octave3D_01(x * 0.08, y * 0.08, z * 0.08, 3) > 0.5 ? 0 : 4;
+    }
+
+    static void FillSurfaceTerrain(Chunk& chunk)
+    {
+        // Rolling hills like the world generator makes: grass over a few blocks of dirt over stone, with some short grass
+        const siv::PerlinNoise perlin{ 12345 };
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                const int height = static_cast<int>(perlin.octave2D_01(x * 0.05, z * 0.05, 4) * 16) + 8;
+                for (int y = 0; y <= height; y++)
+                    chunk.data[x][y][z] = y == height ? 1 : (y > height - 4 ? 2 : 4);
+
+                if ((x * 13 + z * 7) % 11 == 0)
+                    chunk.data[x][height + 1][z] = 3;
+            }
+        }
+    }
+
+    static void FillCheckerboard(Chunk& chunk)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+            for (int y = 0; y < CHUNK_HEIGHT; y++)
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                    chunk.data[x][y][z] = (x + y + z) % 2 == 0 ? 4 : 0;
+    }
+
+    static void FillBorderBlocks(Chunk& chunk)
+    {
+        // Single blocks on every corner, edge and face of the chunk, plus one pair straddling nothing
+        constexpr int maxX = CHUNK_WIDTH - 1, maxY = CHUNK_HEIGHT - 1, maxZ = CHUNK_WIDTH - 1;
+        constexpr int midX = CHUNK_WIDTH / 2, midY = CHUNK_HEIGHT / 2, midZ = CHUNK_WIDTH / 2;
+        for (const int x : {0, midX, maxX})
+            for (const int y : {0, midY, maxY})
+                for (const int z : {0, midZ, maxZ})
+                    if (x != midX || y != midY || z != midZ)
+                        chunk.data[x][y][z] = 9;
+
+        chunk.data[midX][midY][midZ] = 13;
+        chunk.data[midX][midY + 1][midZ] = 11;
+    }
+
+    static void FillDecalField(Chunk& chunk)
+    {
+        // Grass ground covered in every decal type, with some glass mixed in
+        constexpr unsigned char decals[] = {3, 7, 10};
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                for (int y = 0; y < 8; y++)
+                    chunk.data[x][y][z] = y == 7 ? 1 : 2;
+
+                if ((x * 7 + z * 3) % 5 == 0)
+                    chunk.data[x][8][z] = 6;
+                else
+                    chunk.data[x][8][z] = decals[(x + z) % 3];
+            }
+        }
+    }
+
+    const std::vector<Fixture>& GetFixtures()
+    {
+        static const std::vector<Fixture> fixtures
+        {
+            {"All Air", FillAllAir},
+            {"All Stone", FillAllStone},
+            {"Flat Plane", FillFlatPlane},
+            {"Surface Terrain", FillSurfaceTerrain},
+            {"Noise Caves", FillNoiseCaves},
+            {"Checkerboard", FillCheckerboard},
+            {"Border Blocks", FillBorderBlocks},
+            {"Decal Field", FillDecalField},
+        };
+
+        return fixtures;
+    }
+}
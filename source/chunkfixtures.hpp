@@ -0,0 +1,19 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "chunk.hpp"
+
+// Deterministic block layouts for exercising the mesher without a world, window or GPU
+namespace ChunkFixtures
+{
+    struct Fixture
+    {
+        std::string name;
+        std::function<void(Chunk&)> fill;
+    };
+
+    const std::vector<Fixture>& GetFixtures();
+}
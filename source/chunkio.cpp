@@ -0,0 +1,218 @@
+#include "chunkio.hpp"
+
+#include <algorithm>
+
+#include "chunkcodec.hpp"
+#include "raymath.h"
+
+ChunkIo::ChunkIo(RegionStore& store) : store(store)
+{
+    thread = std::thread(&ChunkIo::Run, this);
+}
+
+ChunkIo::~ChunkIo()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    thread.join();
+}
+
+void ChunkIo::SetPlayerChunk(const Vector3 chunkPos)
+{
+    std::lock_guard lock(mutex);
+    playerChunk = chunkPos;
+}
+
+bool ChunkIo::IsSaved(const Vector3 chunkPos)
+{
+    std::unique_lock lock(mutex);
+    indexFinished.wait(lock, [this]() { return indexed; });
+    return savedChunks.contains(GetGridKey(chunkPos));
+}
+
+bool ChunkIo::IsLoading(const Vector3 chunkPos) const
+{
+    std::lock_guard lock(mutex);
+    return loading.contains(GetGridKey(chunkPos));
+}
+
+void ChunkIo::Load(const std::shared_ptr<Chunk>& chunk)
+{
+    {
+        std::lock_guard lock(mutex);
+        loading.insert(GetGridKey(chunk->position));
+        queuedLoads.push_back(chunk);
+    }
+    workAvailable.notify_one();
+}
+
+void ChunkIo::Save(const Chunk& chunk)
+{
+    auto payload = std::make_shared<const std::vector<unsigned char>>(ChunkCodec::Encode(chunk));
+
+    std::unique_lock lock(mutex);
+    savedChunks.insert(GetGridKey(chunk.position));
+
+    // A chunk saved again before the last save was written only needs the latest one written
+    auto& queued = queuedSaves[GetGridKey(chunk.position)];
+    if (queued.payload != nullptr)
+    {
+        queuedSaveBytes -= queued.payload->size();
+        stats.coalescedSaves++;
+    }
+    queuedSaveBytes += payload->size();
+    queued = {chunk.position, std::move(payload)};
+
+    const bool overLimit = queuedSaveBytes > maxQueuedSaveBytes;
+    lock.unlock();
+    if (overLimit)
+        workAvailable.notify_one();
+}
+
+void ChunkIo::RequestFlush()
+{
+    {
+        std::lock_guard lock(mutex);
+        requestedFlushes++;
+    }
+    workAvailable.notify_one();
+}
+
+void ChunkIo::Flush()
+{
+    std::unique_lock lock(mutex);
+    const unsigned long flush = ++requestedFlushes;
+    workAvailable.notify_one();
+    flushFinished.wait(lock, [this, flush]() { return finishedFlushes >= flush; });
+}
+
+std::vector<ChunkIo::LoadResult> ChunkIo::TakeLoaded()
+{
+    std::lock_guard lock(mutex);
+
+    std::vector<LoadResult> result;
+    result.swap(finishedLoads);
+    for (const auto& [chunk, loaded] : result)
+        loading.erase(GetGridKey(chunk->position));
+
+    return result;
+}
+
+ChunkIo::Stats ChunkIo::GetStats() const
+{
+    std::lock_guard lock(mutex);
+
+    Stats result = stats;
+    result.queuedLoads = queuedLoads.size();
+    result.finishedLoads = finishedLoads.size();
+    result.queuedSaves = queuedSaves.size();
+    result.queuedSaveBytes = queuedSaveBytes;
+    return result;
+}
+
+void ChunkIo::Run()
+{
+    IndexSaved();
+
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        workAvailable.wait(lock, [this]()
+        {
+            return stopping || !queuedLoads.empty() || requestedFlushes > finishedFlushes || queuedSaveBytes > maxQueuedSaveBytes;
+        });
+
+        if (stopping || requestedFlushes > finishedFlushes || queuedSaveBytes > maxQueuedSaveBytes)
+            WriteQueuedSaves(lock);
+
+        // Loads nobody is going to take anymore are dropped
+        if (stopping)
+            return;
+
+        if (queuedLoads.empty())
+            continue;
+
+        // The player may have moved since the last batch, so the queue is ordered again every time
+        const Vector3 player = playerChunk;
+        const auto count = std::min(static_cast<std::ptrdiff_t>(loadBatchSize), std::ssize(queuedLoads));
+        std::ranges::partial_sort(queuedLoads, queuedLoads.begin() + count, {}, [player](const std::shared_ptr<Chunk>& chunk)
+        {
+            return Vector3DistanceSqr(chunk->position, player);
+        });
+        std::vector batch(std::make_move_iterator(queuedLoads.begin()), std::make_move_iterator(queuedLoads.begin() + count));
+        queuedLoads.erase(queuedLoads.begin(), queuedLoads.begin() + count);
+
+        lock.unlock();
+        LoadBatch(std::move(batch));
+        lock.lock();
+    }
+}
+
+void ChunkIo::IndexSaved()
+{
+    // Done before anything else, so lookups from other threads never touch the disk themselves
+    const std::vector<Vector3> saved = store.ListSaved();
+
+    std::lock_guard lock(mutex);
+    for (const Vector3 chunkPos : saved)
+        savedChunks.insert(GetGridKey(chunkPos));
+    indexed = true;
+    indexFinished.notify_all();
+}
+
+void ChunkIo::LoadBatch(std::vector<std::shared_ptr<Chunk>> batch)
+{
+    // The disk gets the whole batch at once instead of one payload at a time
+    for (const auto& chunk : batch)
+        store.Prefetch(chunk->position);
+
+    for (auto& chunk : batch)
+    {
+        // A save that wasn't written yet is newer than what is on disk
+        std::shared_ptr<const std::vector<unsigned char>> queued;
+        {
+            std::lock_guard lock(mutex);
+            if (const auto it = queuedSaves.find(GetGridKey(chunk->position)); it != queuedSaves.end())
+                queued = it->second.payload;
+        }
+
+        const bool loaded = queued != nullptr ? ChunkCodec::Decode(queued->data(), queued->size(), *chunk) : store.Load(*chunk);
+
+        std::lock_guard lock(mutex);
+        stats.loads++;
+        finishedLoads.push_back({std::move(chunk), loaded});
+    }
+}
+
+void ChunkIo::WriteQueuedSaves(std::unique_lock<std::mutex>& lock)
+{
+    const unsigned long flush = requestedFlushes;
+    std::vector<RegionStore::PendingSave> batch;
+    batch.reserve(queuedSaves.size());
+    for (const auto& [key, save] : queuedSaves)
+        batch.push_back(save);
+
+    lock.unlock();
+    const int failed = store.SaveBatch(batch);
+    lock.lock();
+
+    // Saves stay queued until written, so loads meanwhile still find them. Ones saved again since stay for the next flush.
+    for (const auto& save : batch)
+    {
+        const auto it = queuedSaves.find(GetGridKey(save.chunkPos));
+        if (it != queuedSaves.end() && it->second.payload == save.payload)
+        {
+            queuedSaveBytes -= save.payload->size();
+            queuedSaves.erase(it);
+        }
+    }
+
+    stats.saves += batch.size() - failed;
+    stats.failedSaves += failed;
+    stats.flushes++;
+    finishedFlushes = std::max(finishedFlushes, flush);
+    flushFinished.notify_all();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hopscotch_map.h"
+#include "hopscotch_set.h"
+#include "chunk.hpp"
+#include "regionstore.hpp"
+
+// Runs all disk access of a region store on its own thread. Loads are served closest to the player first and handed
+// back once done. Saves wait in memory, replacing any earlier save of the same chunk, until a flush writes them out
+// one region file at a time. Which chunks are saved is kept in memory, read from the region files once by the thread.
+class ChunkIo
+{
+    public:
+        struct Stats
+        {
+            size_t queuedLoads = 0;      // Waiting for the thread
+            size_t finishedLoads = 0;    // Done, waiting for TakeLoaded()
+            size_t queuedSaves = 0;      // Waiting for a flush
+            size_t queuedSaveBytes = 0;
+            unsigned long loads = 0, saves = 0, coalescedSaves = 0, failedSaves = 0, flushes = 0;
+        };
+
+        struct LoadResult
+        {
+            std::shared_ptr<Chunk> chunk;
+            bool loaded = false; // False if the saved copy couldn't be read, the chunk is still empty then
+        };
+
+        explicit ChunkIo(RegionStore& store);
+        // Writes whatever is still queued
+        ~ChunkIo();
+        ChunkIo(const ChunkIo&) = delete;
+        ChunkIo& operator=(const ChunkIo&) = delete;
+
+        // Any thread
+        void SetPlayerChunk(Vector3 chunkPos);
+        // Whether there is a saved copy to load, on disk or still queued. Waits for the thread to index the region files the first time.
+        [[nodiscard]] bool IsSaved(Vector3 chunkPos);
+        // Whether a load was asked for and not taken back yet
+        [[nodiscard]] bool IsLoading(Vector3 chunkPos) const;
+        void Load(const std::shared_ptr<Chunk>& chunk);
+        void Save(const Chunk& chunk);
+        // Flush points: the first has the thread write out everything queued so far, the second also waits for it
+        void RequestFlush();
+        void Flush();
+
+        [[nodiscard]] std::vector<LoadResult> TakeLoaded();
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        static constexpr int loadBatchSize = 16;                  // Loads taken at once, then the queue is ordered again
+        static constexpr size_t maxQueuedSaveBytes = 8 * 1024 * 1024; // Flushed early past this
+
+        RegionStore& store;
+
+        std::vector<std::shared_ptr<Chunk>> queuedLoads;
+        std::vector<LoadResult> finishedLoads;
+        tsl::hopscotch_set<uint64_t> loading; // Keys of both of the above and the batch being loaded
+        tsl::hopscotch_map<uint64_t, RegionStore::PendingSave> queuedSaves;
+        tsl::hopscotch_set<uint64_t> savedChunks; // On disk or queued, kept even if writing one fails since its load then fails too
+        bool indexed = false;                     // Whether savedChunks covers the region files yet
+        size_t queuedSaveBytes = 0;
+        Vector3 playerChunk {};
+        Stats stats;
+
+        unsigned long requestedFlushes = 0, finishedFlushes = 0;
+        bool stopping = false;
+        mutable std::mutex mutex;
+        std::condition_variable workAvailable, flushFinished, indexFinished;
+        std::thread thread;
+
+        void Run();
+        void IndexSaved();
+        void LoadBatch(std::vector<std::shared_ptr<Chunk>> batch);
+        void WriteQueuedSaves(std::unique_lock<std::mutex>& lock);
+};
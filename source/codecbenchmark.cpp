@@ -0,0 +1,120 @@
+#include "codecbenchmark.hpp"
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "blocktype.hpp"
+#include "chunkcodec.hpp"
+#include "terraingenerator.hpp"
+
+namespace CodecBenchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each measurement runs for at least this long, and at least minIterations times over its chunks
+    static constexpr std::chrono::milliseconds minDuration {250};
+    static constexpr int minIterations = 3;
+    // Sizes and speeds are against a byte per block, what the block types need
+    static constexpr int rawBytes = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH;
+
+    // The world's terrain keeps its surface between y 200 and 264, chunk rows 6 to 8
+    static constexpr int sizeX = 6, sizeZ = 6;
+    static constexpr std::array<std::pair<const char*, std::pair<int, int>>, 3> layers = {{{"Underground", {3, 5}}, {"Surface", {6, 8}}, {"Sky", {9, 10}}}};
+
+    static constexpr std::array<std::pair<const char*, ChunkCodec::Format>, 3> formats = {{
+        {"Packed", ChunkCodec::Format::Packed}, {"Runs", ChunkCodec::Format::Runs}, {"Runs + LZ", ChunkCodec::Format::RunsLz}}};
+
+    static std::vector<std::unique_ptr<Chunk>> MakeChunks(const TerrainGenerator& terrain, const int minY, const int maxY)
+    {
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (int x = 0; x < sizeX; x++)
+        {
+            for (int y = minY; y <= maxY; y++)
+            {
+                for (int z = 0; z < sizeZ; z++)
+                {
+                    chunks.push_back(std::make_unique<Chunk>(nullptr, Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}));
+                    terrain.Generate(*chunks.back());
+                }
+            }
+        }
+
+        return chunks;
+    }
+
+    // Runs the operation over all chunks until the minimum is reached; returns the seconds per chunk
+    template <typename Operation>
+    static double Measure(const size_t chunkCount, Operation operation)
+    {
+        const auto start = Clock::now();
+        int iterations = 0;
+        while (iterations < minIterations || Clock::now() - start < minDuration)
+        {
+            for (size_t i = 0; i < chunkCount; i++)
+                operation(i);
+            iterations++;
+        }
+
+        return std::chrono::duration<double>(Clock::now() - start).count() / (static_cast<double>(iterations) * chunkCount);
+    }
+
+    int Run()
+    {
+        const TerrainGenerator terrain(12345);
+
+        std::cout << "Chunk codec benchmark, " << sizeX * sizeZ << " generated chunks per layer, ratio and MB/s against a byte per block"
+                  << std::endl << std::endl;
+        std::cout << std::left << std::setw(14) << "Layer" << std::setw(12) << "Format" << std::right << std::setw(12) << "bytes/chunk"
+                  << std::setw(10) << "ratio" << std::setw(12) << "enc us" << std::setw(12) << "dec us" << std::setw(12) << "enc MB/s"
+                  << std::setw(12) << "dec MB/s" << std::endl;
+
+        int mismatches = 0, acceptedDamaged = 0;
+        Chunk decoded(nullptr, Vector3{0, 0, 0});
+        for (const auto& [layerName, rows] : layers)
+        {
+            const auto chunks = MakeChunks(terrain, rows.first, rows.second);
+            for (const auto& [formatName, format] : formats)
+            {
+                std::vector<std::vector<unsigned char>> blobs(chunks.size());
+                const double encodeSeconds = Measure(chunks.size(), [&](const size_t i) { blobs[i] = ChunkCodec::Encode(*chunks[i], format); });
+                const double decodeSeconds = Measure(chunks.size(), [&](const size_t i) { ChunkCodec::Decode(blobs[i].data(), blobs[i].size(), decoded); });
+
+                size_t bytes = 0;
+                for (size_t i = 0; i < chunks.size(); i++)
+                {
+                    bytes += blobs[i].size();
+                    if (!ChunkCodec::Decode(blobs[i].data(), blobs[i].size(), decoded) || decoded.data != chunks[i]->data)
+                        mismatches++;
+
+                    // A block type past the last one in the palette has to make the blob unreadable
+                    std::vector<unsigned char> damaged = blobs[i];
+                    damaged[2 + damaged[1]] = static_cast<unsigned char>(BlockType::Types.size());
+                    if (ChunkCodec::Decode(damaged.data(), damaged.size(), decoded))
+                        acceptedDamaged++;
+                }
+
+                const double averageBytes = static_cast<double>(bytes) / chunks.size();
+                std::cout << std::left << std::setw(14) << layerName << std::setw(12) << formatName << std::right << std::fixed
+                          << std::setprecision(1) << std::setw(12) << averageBytes << std::setw(9) << rawBytes / averageBytes << "x"
+                          << std::setw(12) << encodeSeconds * 1e6 << std::setw(12) << decodeSeconds * 1e6
+                          << std::setprecision(0) << std::setw(12) << rawBytes / encodeSeconds / 1e6 << std::setw(12)
+                          << rawBytes / decodeSeconds / 1e6 << std::endl;
+            }
+        }
+
+        if (mismatches > 0 || acceptedDamaged > 0)
+        {
+            std::cout << std::endl << "FAIL " << mismatches << " chunks did not decode back as encoded, " << acceptedDamaged
+                      << " with a damaged palette decoded anyway" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::endl << "PASS every chunk decoded back as encoded, and none with a damaged palette" << std::endl;
+        return 0;
+    }
+}
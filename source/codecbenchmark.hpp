@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless benchmark of the chunk codec's formats on generated terrain: payload size, compression ratio and encode and
+// decode speed, for chunks below, at and above the surface
+namespace CodecBenchmark
+{
+    // Encodes and decodes every chunk in every format, checking each round trip; returns a process exit code
+    int Run();
+}
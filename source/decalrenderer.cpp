@@ -0,0 +1,124 @@
+#include "decalrenderer.hpp"
+
+#include "raymath.h"
+#include "rlgl.h"
+#include "backend.hpp"
+
+#include "blockmodel.hpp"
+#include "blocktype.hpp"
+
+void DecalBatch::Unload()
+{
+    if (vaoId != 0)
+        Backend::UnloadVertexArray(vaoId);
+    if (instanceVboId != 0)
+        Backend::UnloadVertexBuffer(instanceVboId);
+
+    vaoId = instanceVboId = 0;
+    uploadedCount = 0;
+}
+
+void DecalRenderer::Load(const Shader shader, const Texture2D texture)
+{
+    this->shader = shader;
+    this->texture = texture;
+    instanceLocation = Backend::GetShaderLocationAttrib(shader, "instanceData");
+    blockmapSizeLocation = Backend::GetShaderLocation(shader, "blockmapSize");
+
+    // Interleaved position and texcoord of every vertex of the decal model, the shader places it in the blockmap
+    std::vector<float> cross;
+    for (const auto& face : BlockModel::Decal.faces)
+    {
+        for (const auto& vertex : face.vertices)
+            cross.insert(cross.end(), {vertex[0], vertex[1], vertex[2], vertex[6], vertex[7]});
+    }
+    crossVertexCount = static_cast<int>(cross.size() / 5);
+    crossVboId = Backend::LoadVertexBuffer(cross.data(), static_cast<int>(cross.size() * sizeof(float)), false);
+}
+
+void DecalRenderer::Unload()
+{
+    if (crossVboId != 0)
+        Backend::UnloadVertexBuffer(crossVboId);
+    crossVboId = 0;
+}
+
+void DecalRenderer::Upload(DecalBatch& batch) const
+{
+    // The instance count changes with edits, so the instance buffer is recreated rather than updated
+    if (batch.instanceVboId != 0)
+        Backend::UnloadVertexBuffer(batch.instanceVboId);
+    batch.instanceVboId = 0;
+    batch.uploadedCount = static_cast<int>(batch.instances.size());
+    if (batch.instances.empty())
+        return;
+
+    if (batch.vaoId == 0)
+    {
+        batch.vaoId = Backend::LoadVertexArray();
+        Backend::EnableVertexArray(batch.vaoId);
+
+        Backend::EnableVertexBuffer(crossVboId);
+        Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, 5 * sizeof(float), 0);
+        Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+        Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, 5 * sizeof(float), 3 * sizeof(float));
+        Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+    }
+    else
+    {
+        Backend::EnableVertexArray(batch.vaoId);
+    }
+
+    // One x, y, z, texture index quadruple per instance, read as plain (not normalized) numbers
+    batch.instanceVboId = Backend::LoadVertexBuffer(batch.instances.data(), static_cast<int>(batch.instances.size() * sizeof(DecalInstance)), false);
+    if (instanceLocation != -1)
+    {
+        Backend::SetVertexAttribute(instanceLocation, 4, RL_UNSIGNED_BYTE, false, sizeof(DecalInstance), 0);
+        Backend::SetVertexAttributeDivisor(instanceLocation, 1);
+        Backend::EnableVertexAttribute(instanceLocation);
+    }
+
+    Backend::DisableVertexBuffer();
+    Backend::DisableVertexArray();
+}
+
+void DecalRenderer::Begin() const
+{
+    Backend::EnableShader(shader.id);
+
+    if (shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+    {
+        constexpr float white[4] = {1, 1, 1, 1};
+        Backend::SetUniform(shader.locs[SHADER_LOC_COLOR_DIFFUSE], white, SHADER_UNIFORM_VEC4, 1);
+    }
+    if (blockmapSizeLocation != -1)
+    {
+        const float blockmapSize[2] = {BlockType::blockmapWidth, BlockType::blockmapHeight};
+        Backend::SetUniform(blockmapSizeLocation, blockmapSize, SHADER_UNIFORM_VEC2, 1);
+    }
+
+    constexpr int textureSlot = 0;
+    Backend::ActiveTextureSlot(textureSlot);
+    Backend::EnableTexture(texture.id);
+    Backend::SetUniform(shader.locs[SHADER_LOC_MAP_ALBEDO], &textureSlot, SHADER_UNIFORM_INT, 1);
+}
+
+void DecalRenderer::Draw(const DecalBatch& batch, const Vector3 offset) const
+{
+    if (batch.uploadedCount == 0 || batch.instanceVboId == 0)
+        return;
+
+    const Matrix matModel = MatrixMultiply(MatrixTranslate(offset.x, offset.y, offset.z), rlGetMatrixTransform());
+    Backend::SetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(MatrixMultiply(matModel, rlGetMatrixModelview()), rlGetMatrixProjection()));
+
+    Backend::EnableVertexArray(batch.vaoId);
+    Backend::DrawVertexArrayInstanced(0, crossVertexCount, batch.uploadedCount);
+    Backend::DisableVertexArray();
+}
+
+void DecalRenderer::End() const
+{
+    Backend::ActiveTextureSlot(0);
+    Backend::DisableTexture();
+    Backend::DisableShader();
+}
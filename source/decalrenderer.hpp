@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+
+// One decal block, drawn as an instance of the shared decal cross
+struct DecalInstance
+{
+    unsigned char x = 0, y = 0, z = 0; // Position inside the chunk
+    unsigned char textureIndex = 0;    // Tile of the blockmap
+};
+
+// The decals of one chunk and the GPU buffers they were last uploaded to
+struct DecalBatch
+{
+    std::vector<DecalInstance> instances;
+    unsigned int vaoId = 0, instanceVboId = 0;
+    int uploadedCount = 0;
+
+    void Unload();
+};
+
+// Draws decal blocks (grass, flowers, ...) instanced from one cross of quads, instead of baking their vertices into chunk meshes
+class DecalRenderer
+{
+    public:
+        DecalRenderer() = default;
+
+        void Load(Shader shader, Texture2D texture);
+        void Unload();
+
+        void Upload(DecalBatch& batch) const;
+
+        // Draw calls for all batches go between Begin and End
+        void Begin() const;
+        void Draw(const DecalBatch& batch, Vector3 offset) const;
+        void End() const;
+    private:
+        Shader shader {};
+        Texture2D texture {};
+        unsigned int crossVboId = 0;
+        int crossVertexCount = 0;
+        int instanceLocation = -1;
+        int blockmapSizeLocation = -1;
+};
@@ -0,0 +1,508 @@
+#include "backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP) && defined(GRAPHICS_API_OPENGL_33)
+// rlgl doesn't wrap multi-draws, but raylib's desktop platform is built on GLFW, which can look them up
+using GLFWglproc = void (*)();
+extern "C" GLFWglproc glfwGetProcAddress(const char* procname);
+#endif
+
+namespace Backend
+{
+    using Clock = std::chrono::steady_clock;
+
+    static bool isNull = false;
+    static Stats stats;
+
+    // Null backend state
+    static unsigned int nextId = 1; // Placeholder ids, never 0 so everything counts as loaded
+    static int targetFps = 0;
+    static Clock::time_point lastFrameEnd = Clock::now();
+    static float frameTime = 0;
+
+    // GL functions rlgl doesn't wrap, looked up on first use once the GL context exists; nullptr where they can't be
+    template <typename Proc>
+    static Proc LoadGlProc([[maybe_unused]] const char* name)
+    {
+#if defined(PLATFORM_DESKTOP) && defined(GRAPHICS_API_OPENGL_33)
+        return reinterpret_cast<Proc>(glfwGetProcAddress(name));
+#else
+        return nullptr;
+#endif
+    }
+
+    using MultiDrawArraysProc = void (*)(unsigned int mode, const int* first, const int* count, int drawCount);
+    static MultiDrawArraysProc GetMultiDrawArrays()
+    {
+        static const auto proc = LoadGlProc<MultiDrawArraysProc>("glMultiDrawArrays");
+        return proc;
+    }
+
+    using BindBufferProc = void (*)(unsigned int target, unsigned int buffer);
+    using CopyBufferSubDataProc = void (*)(unsigned int readTarget, unsigned int writeTarget, std::ptrdiff_t readOffset, std::ptrdiff_t writeOffset, std::ptrdiff_t size);
+    static std::pair<BindBufferProc, CopyBufferSubDataProc> GetCopyBufferSubData()
+    {
+        static const std::pair procs = {LoadGlProc<BindBufferProc>("glBindBuffer"), LoadGlProc<CopyBufferSubDataProc>("glCopyBufferSubData")};
+        return procs;
+    }
+
+    static int* NewShaderLocations()
+    {
+        // Nothing is ever found in a null shader
+        const auto locations = static_cast<int*>(MemAlloc(RL_MAX_SHADER_LOCATIONS * sizeof(int)));
+        std::fill_n(locations, RL_MAX_SHADER_LOCATIONS, -1);
+        return locations;
+    }
+
+    void UseNull()
+    {
+        isNull = true;
+        lastFrameEnd = Clock::now();
+    }
+
+    bool IsNull()
+    {
+        return isNull;
+    }
+
+    const Stats& GetStats()
+    {
+        return stats;
+    }
+
+    void InitWindow(const int width, const int height, const char* title)
+    {
+        if (!isNull)
+            ::InitWindow(width, height, title);
+    }
+
+    void CloseWindow()
+    {
+        if (!isNull)
+            ::CloseWindow();
+    }
+
+    bool WindowShouldClose()
+    {
+        return !isNull && ::WindowShouldClose();
+    }
+
+    void SetTargetFPS(const int fps)
+    {
+        if (isNull)
+            targetFps = fps;
+        else
+            ::SetTargetFPS(fps);
+    }
+
+    float GetFrameTime()
+    {
+        return isNull ? frameTime : ::GetFrameTime();
+    }
+
+    void BeginDrawing()
+    {
+        if (!isNull)
+            ::BeginDrawing();
+    }
+
+    void EndDrawing()
+    {
+        stats.frames++;
+        if (!isNull)
+        {
+            ::EndDrawing();
+            return;
+        }
+
+        if (targetFps > 0)
+            std::this_thread::sleep_until(lastFrameEnd + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps)));
+        const auto now = Clock::now();
+        frameTime = std::chrono::duration<float>(now - lastFrameEnd).count();
+        lastFrameEnd = now;
+    }
+
+    void ClearBackground(const Color color)
+    {
+        if (!isNull)
+            ::ClearBackground(color);
+    }
+
+    void BeginMode3D(const Camera3D& camera)
+    {
+        if (!isNull)
+            ::BeginMode3D(camera);
+    }
+
+    void EndMode3D()
+    {
+        if (!isNull)
+            ::EndMode3D();
+    }
+
+    void DrawFPS(const int x, const int y)
+    {
+        if (!isNull)
+            ::DrawFPS(x, y);
+    }
+
+    void DrawText(const char* text, const int x, const int y, const int fontSize, const Color color)
+    {
+        if (!isNull)
+            ::DrawText(text, x, y, fontSize, color);
+    }
+
+    void SetClipPlanes(const double nearPlane, const double farPlane)
+    {
+        if (!isNull)
+            rlSetClipPlanes(nearPlane, farPlane);
+    }
+
+    void InitAudioDevice()
+    {
+        if (!isNull)
+            ::InitAudioDevice();
+    }
+
+    void CloseAudioDevice()
+    {
+        if (!isNull)
+            ::CloseAudioDevice();
+    }
+
+    Music LoadMusicStream(const char* path)
+    {
+        return isNull ? Music{} : ::LoadMusicStream(path);
+    }
+
+    void UnloadMusicStream(const Music& music)
+    {
+        if (!isNull)
+            ::UnloadMusicStream(music);
+    }
+
+    void PlayMusicStream(const Music& music)
+    {
+        if (!isNull)
+            ::PlayMusicStream(music);
+    }
+
+    void UpdateMusicStream(const Music& music)
+    {
+        if (!isNull)
+            ::UpdateMusicStream(music);
+    }
+
+    void SetMusicVolume(const Music& music, const float volume)
+    {
+        if (!isNull)
+            ::SetMusicVolume(music, volume);
+    }
+
+    Shader LoadShader(const char* vertexPath, const char* fragmentPath)
+    {
+        if (isNull)
+            return {nextId++, NewShaderLocations()};
+        return ::LoadShader(vertexPath, fragmentPath);
+    }
+
+    void UnloadShader(const Shader& shader)
+    {
+        if (isNull)
+            MemFree(shader.locs);
+        else
+            ::UnloadShader(shader);
+    }
+
+    int GetShaderLocation(const Shader& shader, const char* name)
+    {
+        return isNull ? -1 : ::GetShaderLocation(shader, name);
+    }
+
+    int GetShaderLocationAttrib(const Shader& shader, const char* name)
+    {
+        return isNull ? -1 : ::GetShaderLocationAttrib(shader, name);
+    }
+
+    void SetShaderValue(const Shader& shader, const int location, const void* value, const int uniformType)
+    {
+        if (!isNull)
+            ::SetShaderValue(shader, location, value, uniformType);
+    }
+
+    Material LoadMaterialDefault()
+    {
+        if (!isNull)
+            return ::LoadMaterialDefault();
+
+        constexpr int mapCount = 12; // MAX_MATERIAL_MAPS of raylib's config
+        static const Shader defaultShader = {nextId++, NewShaderLocations()};
+        Material material {};
+        material.shader = defaultShader;
+        material.maps = static_cast<MaterialMap*>(MemAlloc(mapCount * sizeof(MaterialMap)));
+        material.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
+        return material;
+    }
+
+    Texture2D LoadTexture(const char* path)
+    {
+        if (!isNull)
+            return ::LoadTexture(path);
+
+        const Image image = LoadImage(path);
+        const Texture2D texture = Backend::LoadTextureFromImage(image);
+        UnloadImage(image);
+        return texture;
+    }
+
+    Texture2D LoadTextureFromImage(const Image& image)
+    {
+        for (int level = 0; level < image.mipmaps; level++)
+            stats.uploadedBytes += GetPixelDataSize(std::max(image.width >> level, 1), std::max(image.height >> level, 1), image.format);
+
+        if (isNull)
+            return {nextId++, image.width, image.height, image.mipmaps, image.format};
+        return ::LoadTextureFromImage(image);
+    }
+
+    void UnloadTexture(const Texture2D& texture)
+    {
+        if (!isNull)
+            ::UnloadTexture(texture);
+    }
+
+    void SetTextureParameter(const unsigned int textureId, const int parameter, const int value)
+    {
+        if (!isNull)
+            rlTextureParameters(textureId, parameter, value);
+    }
+
+    void UploadMesh(Mesh* mesh, const bool dynamic)
+    {
+        // Whichever arrays the mesh has
+        const size_t vertexCount = mesh->vertexCount;
+        stats.uploadedBytes += (mesh->vertices != nullptr ? vertexCount * 3 * sizeof(float) : 0) +
+                               (mesh->texcoords != nullptr ? vertexCount * 2 * sizeof(float) : 0) +
+                               (mesh->normals != nullptr ? vertexCount * 3 * sizeof(float) : 0) +
+                               (mesh->colors != nullptr ? vertexCount * 4 * sizeof(unsigned char) : 0) +
+                               (mesh->indices != nullptr ? mesh->triangleCount * 3 * sizeof(unsigned short) : 0);
+
+        if (!isNull)
+        {
+            ::UploadMesh(mesh, dynamic);
+            return;
+        }
+
+        // Same ownership as raylib's, UnloadMesh frees the buffer id array
+        constexpr int bufferCount = 16;
+        mesh->vaoId = nextId++;
+        mesh->vboId = static_cast<unsigned int*>(MemAlloc(bufferCount * sizeof(unsigned int)));
+    }
+
+    void UnloadMesh(const Mesh& mesh)
+    {
+        if (!isNull)
+        {
+            ::UnloadMesh(mesh);
+            return;
+        }
+
+        MemFree(mesh.vboId);
+        MemFree(mesh.vertices);
+        MemFree(mesh.texcoords);
+        MemFree(mesh.texcoords2);
+        MemFree(mesh.normals);
+        MemFree(mesh.tangents);
+        MemFree(mesh.colors);
+        MemFree(mesh.indices);
+        MemFree(mesh.animVertices);
+        MemFree(mesh.animNormals);
+        MemFree(mesh.boneWeights);
+        MemFree(mesh.boneIds);
+    }
+
+    void DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform)
+    {
+        stats.drawCalls++;
+        stats.vertices += mesh.indices != nullptr ? mesh.triangleCount * 3 : mesh.vertexCount;
+        if (!isNull)
+            ::DrawMesh(mesh, material, transform);
+    }
+
+    unsigned int LoadVertexArray()
+    {
+        return isNull ? nextId++ : rlLoadVertexArray();
+    }
+
+    void UnloadVertexArray(const unsigned int vaoId)
+    {
+        if (!isNull)
+            rlUnloadVertexArray(vaoId);
+    }
+
+    void EnableVertexArray(const unsigned int vaoId)
+    {
+        if (!isNull)
+            rlEnableVertexArray(vaoId);
+    }
+
+    void DisableVertexArray()
+    {
+        if (!isNull)
+            rlDisableVertexArray();
+    }
+
+    unsigned int LoadVertexBuffer(const void* data, const int size, const bool dynamic)
+    {
+        if (data != nullptr)
+            stats.uploadedBytes += size;
+        return isNull ? nextId++ : rlLoadVertexBuffer(data, size, dynamic);
+    }
+
+    void UnloadVertexBuffer(const unsigned int vboId)
+    {
+        if (!isNull)
+            rlUnloadVertexBuffer(vboId);
+    }
+
+    void UpdateVertexBuffer(const unsigned int vboId, const void* data, const int size, const int offset)
+    {
+        stats.uploadedBytes += size;
+        if (!isNull)
+            rlUpdateVertexBuffer(vboId, data, size, offset);
+    }
+
+    bool CanCopyVertexBuffers()
+    {
+        if (isNull)
+            return true;
+        const auto [bindBuffer, copyBufferSubData] = GetCopyBufferSubData();
+        return bindBuffer != nullptr && copyBufferSubData != nullptr;
+    }
+
+    void CopyVertexBuffer(const unsigned int sourceVboId, const unsigned int destinationVboId, const int size)
+    {
+        if (isNull)
+            return;
+
+        constexpr unsigned int copyReadBuffer = 0x8F36, copyWriteBuffer = 0x8F37; // GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER
+        const auto [bindBuffer, copyBufferSubData] = GetCopyBufferSubData();
+        bindBuffer(copyReadBuffer, sourceVboId);
+        bindBuffer(copyWriteBuffer, destinationVboId);
+        copyBufferSubData(copyReadBuffer, copyWriteBuffer, 0, 0, size);
+        bindBuffer(copyReadBuffer, 0);
+        bindBuffer(copyWriteBuffer, 0);
+    }
+
+    void EnableVertexBuffer(const unsigned int vboId)
+    {
+        if (!isNull)
+            rlEnableVertexBuffer(vboId);
+    }
+
+    void DisableVertexBuffer()
+    {
+        if (!isNull)
+            rlDisableVertexBuffer();
+    }
+
+    void SetVertexAttribute(const unsigned int index, const int componentCount, const int type, const bool normalized, const int stride, const int offset)
+    {
+        if (!isNull)
+            rlSetVertexAttribute(index, componentCount, type, normalized, stride, offset);
+    }
+
+    void EnableVertexAttribute(const unsigned int index)
+    {
+        if (!isNull)
+            rlEnableVertexAttribute(index);
+    }
+
+    void SetVertexAttributeDivisor(const unsigned int index, const int divisor)
+    {
+        if (!isNull)
+            rlSetVertexAttributeDivisor(index, divisor);
+    }
+
+    void EnableShader(const unsigned int shaderId)
+    {
+        if (!isNull)
+            rlEnableShader(shaderId);
+    }
+
+    void DisableShader()
+    {
+        if (!isNull)
+            rlDisableShader();
+    }
+
+    void SetUniform(const int location, const void* value, const int uniformType, const int count)
+    {
+        if (!isNull)
+            rlSetUniform(location, value, uniformType, count);
+    }
+
+    void SetUniformMatrix(const int location, const Matrix& matrix)
+    {
+        if (!isNull)
+            rlSetUniformMatrix(location, matrix);
+    }
+
+    void ActiveTextureSlot(const int slot)
+    {
+        if (!isNull)
+            rlActiveTextureSlot(slot);
+    }
+
+    void EnableTexture(const unsigned int textureId)
+    {
+        if (!isNull)
+            rlEnableTexture(textureId);
+    }
+
+    void DisableTexture()
+    {
+        if (!isNull)
+            rlDisableTexture();
+    }
+
+    void DrawVertexArray(const int firstVertex, const int vertexCount)
+    {
+        stats.drawCalls++;
+        stats.vertices += vertexCount;
+        if (!isNull)
+            rlDrawVertexArray(firstVertex, vertexCount);
+    }
+
+    void MultiDrawVertexArray(const int* firstVertices, const int* vertexCounts, const int drawCount)
+    {
+        stats.drawCalls++;
+        for (int i = 0; i < drawCount; i++)
+            stats.vertices += vertexCounts[i];
+        if (isNull)
+            return;
+
+        if (const MultiDrawArraysProc multiDrawArrays = GetMultiDrawArrays(); multiDrawArrays != nullptr)
+        {
+            multiDrawArrays(RL_TRIANGLES, firstVertices, vertexCounts, drawCount);
+            return;
+        }
+        for (int i = 0; i < drawCount; i++)
+            rlDrawVertexArray(firstVertices[i], vertexCounts[i]);
+    }
+
+    void DrawVertexArrayInstanced(const int firstVertex, const int vertexCount, const int instances)
+    {
+        stats.drawCalls++;
+        stats.vertices += static_cast<unsigned long long>(vertexCount) * instances;
+        if (!isNull)
+            rlDrawVertexArrayInstanced(firstVertex, vertexCount, instances);
+    }
+}
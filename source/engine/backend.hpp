@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+
+#include "raylib.h"
+
+// Every call that needs a window, a GL context or an audio device goes through here. By default they go straight to raylib
+// and rlgl. The null backend skips them and hands out placeholder ids instead, so the whole frame loop runs headless.
+// Both count what was drawn and uploaded.
+namespace Backend
+{
+    struct Stats
+    {
+        unsigned long frames = 0;
+        unsigned long drawCalls = 0;
+        unsigned long long vertices = 0;      // Drawn, every instance counted
+        unsigned long long uploadedBytes = 0; // Vertex, instance and texture data sent to the GPU
+    };
+
+    // Switches to the null backend; call before anything else in here
+    void UseNull();
+    [[nodiscard]] bool IsNull();
+    // Render thread
+    [[nodiscard]] const Stats& GetStats();
+
+    // Window and frame
+    void InitWindow(int width, int height, const char* title);
+    void CloseWindow();
+    [[nodiscard]] bool WindowShouldClose();
+    void SetTargetFPS(int fps);
+    [[nodiscard]] float GetFrameTime();
+    void BeginDrawing();
+    void EndDrawing(); // The null backend waits out the target frame time like raylib does
+    void ClearBackground(Color color);
+    void BeginMode3D(const Camera3D& camera);
+    void EndMode3D();
+    void DrawFPS(int x, int y);
+    void DrawText(const char* text, int x, int y, int fontSize, Color color);
+    void SetClipPlanes(double nearPlane, double farPlane);
+
+    // Audio
+    void InitAudioDevice();
+    void CloseAudioDevice();
+    [[nodiscard]] Music LoadMusicStream(const char* path);
+    void UnloadMusicStream(const Music& music);
+    void PlayMusicStream(const Music& music);
+    void UpdateMusicStream(const Music& music);
+    void SetMusicVolume(const Music& music, float volume);
+
+    // Shaders, materials and textures
+    [[nodiscard]] Shader LoadShader(const char* vertexPath, const char* fragmentPath);
+    void UnloadShader(const Shader& shader);
+    [[nodiscard]] int GetShaderLocation(const Shader& shader, const char* name);
+    [[nodiscard]] int GetShaderLocationAttrib(const Shader& shader, const char* name);
+    void SetShaderValue(const Shader& shader, int location, const void* value, int uniformType);
+    [[nodiscard]] Material LoadMaterialDefault();
+    [[nodiscard]] Texture2D LoadTexture(const char* path);
+    [[nodiscard]] Texture2D LoadTextureFromImage(const Image& image);
+    void UnloadTexture(const Texture2D& texture);
+    void SetTextureParameter(unsigned int textureId, int parameter, int value);
+
+    // Meshes
+    void UploadMesh(Mesh* mesh, bool dynamic);
+    void UnloadMesh(const Mesh& mesh); // Frees the CPU arrays too, like raylib's
+    void DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform);
+
+    // Vertex arrays and buffers
+    [[nodiscard]] unsigned int LoadVertexArray();
+    void UnloadVertexArray(unsigned int vaoId);
+    void EnableVertexArray(unsigned int vaoId);
+    void DisableVertexArray();
+    [[nodiscard]] unsigned int LoadVertexBuffer(const void* data, int size, bool dynamic);
+    void UnloadVertexBuffer(unsigned int vboId);
+    void UpdateVertexBuffer(unsigned int vboId, const void* data, int size, int offset);
+    // Copies the first size bytes of one buffer into another on the GPU, if CanCopyVertexBuffers; not counted as an upload
+    [[nodiscard]] bool CanCopyVertexBuffers();
+    void CopyVertexBuffer(unsigned int sourceVboId, unsigned int destinationVboId, int size);
+    void EnableVertexBuffer(unsigned int vboId);
+    void DisableVertexBuffer();
+    void SetVertexAttribute(unsigned int index, int componentCount, int type, bool normalized, int stride, int offset);
+    void EnableVertexAttribute(unsigned int index);
+    void SetVertexAttributeDivisor(unsigned int index, int divisor);
+
+    // Draw state and draws from the bound vertex array
+    void EnableShader(unsigned int shaderId);
+    void DisableShader();
+    void SetUniform(int location, const void* value, int uniformType, int count);
+    void SetUniformMatrix(int location, const Matrix& matrix);
+    void ActiveTextureSlot(int slot);
+    void EnableTexture(unsigned int textureId);
+    void DisableTexture();
+    void DrawVertexArray(int firstVertex, int vertexCount);
+    // One glMultiDrawArrays where available, otherwise one draw per range; counted as a single draw call
+    void MultiDrawVertexArray(const int* firstVertices, const int* vertexCounts, int drawCount);
+    void DrawVertexArrayInstanced(int firstVertex, int vertexCount, int instances);
+}
@@ -1,27 +1,139 @@
 #include "core.hpp"
 
-Core::Core() : camera((Camera){{ 16, 240, 16 }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, 60.0f, 0}), world(World(&camera))
-{}
+#include <chrono>
 
-Core::~Core() = default;
+#include "backend.hpp"
+
+Core::Core(const std::filesystem::path& saveDirectory) : camera((Camera){{ 16, 240, 16 }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, 60.0f, 0}), world(camera.position, saveDirectory),
+               governor({.maxWorkers = world.GetWorkerCount()}, world.GetRenderDistance(), world.GetUploadBudget(), world.GetWorkerCount()),
+               playerPosition(camera.position)
+{
+    simulationThread = std::thread(&Core::RunSimulation, this);
+}
+
+Core::~Core()
+{
+    running = false;
+    simulationThread.join();
+}
 
 void Core::Update(float deltaTime)
 {
+    frameStart = std::chrono::steady_clock::now();
+
+    // Judge the previous frame, and hand whatever the governor decided to the world
+    if (governor.AddFrame({deltaTime * 1000.0, workMilliseconds, world.GetPendingUploads(), tickMilliseconds}))
+    {
+        const FrameGovernor::Metrics& metrics = governor.GetMetrics();
+        world.SetRenderDistance(metrics.renderDistance);
+        world.SetUploadBudget(metrics.uploadBytesPerFrame);
+        world.SetWorkerCount(metrics.workers);
+    }
+
     UpdateCamera(&camera, CAMERA_FREE);
-    world.Update();
+
+    if (IsKeyPressed(KEY_F3))
+    {
+        showDebugInfo = !showDebugInfo;
+        governor.SetLogDecisions(showDebugInfo);
+    }
+
+    std::lock_guard lock(inputMutex);
+    playerPosition = camera.position;
+
+    // Break blocks with left click, place stone with right click
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+        pendingEdits.push_back({camera.position, Vector3Normalize(Vector3Subtract(camera.target, camera.position)), !IsMouseButtonPressed(MOUSE_BUTTON_LEFT)});
 }
 
-void Core::Render() const
+void Core::Render()
 {
-    BeginDrawing();
+    Backend::BeginDrawing();
     {
-        ClearBackground(SKYBLUE);
-        BeginMode3D(camera);
+        Backend::ClearBackground(SKYBLUE);
+        Backend::BeginMode3D(camera);
         {
-            world.RenderChunks();
+            world.RenderChunks(camera);
+        }
+        Backend::EndMode3D();
+        Backend::DrawFPS(20, 20);
+
+        if (showDebugInfo)
+        {
+            const FrameGovernor::Metrics& metrics = governor.GetMetrics();
+            Backend::DrawText(TextFormat("frame %.1f ms (work %.1f) tick %.1f ms", metrics.frameMilliseconds, metrics.workMilliseconds, metrics.tickMilliseconds), 20, 45, 10, BLACK);
+            Backend::DrawText(TextFormat("distance %d, upload %d KB/frame, %d workers, %d uploads pending", metrics.renderDistance,
+                                static_cast<int>(metrics.uploadBytesPerFrame / 1024), metrics.workers, metrics.pendingUploads), 20, 60, 10, BLACK);
+            Backend::DrawText(metrics.lastDecision.c_str(), 20, 75, 10, BLACK);
+            Backend::DrawText(TextFormat("opaque chunk meshes %d KB on the GPU, all chunk meshes %d KB on the CPU", static_cast<int>(world.GetArenaBytes() / 1024),
+                                static_cast<int>(World::GetCpuMeshBytes() / 1024)), 20, 90, 10, BLACK);
+            const ChunkIo::Stats io = world.GetIoStats();
+            Backend::DrawText(TextFormat("chunk io: %d loads queued, %d saves queued (%d KB), %d flushes", static_cast<int>(io.queuedLoads + io.finishedLoads),
+                                static_cast<int>(io.queuedSaves), static_cast<int>(io.queuedSaveBytes / 1024), static_cast<int>(io.flushes)), 20, 105, 10, BLACK);
         }
-        EndMode3D();
-        DrawFPS(20, 20);
     }
-    EndDrawing();
+    workMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    Backend::EndDrawing();
+}
+
+void Core::SetCamera(const Vector3 position, const Vector3 target)
+{
+    camera.position = position;
+    camera.target = target;
+}
+
+const World& Core::GetWorld() const
+{
+    return world;
+}
+
+const FrameGovernor& Core::GetGovernor() const
+{
+    return governor;
+}
+
+void Core::RunSimulation()
+{
+    // Fixed ticks, independent of the frame rate. A tick that runs long delays the next ones but never a frame.
+    using Clock = std::chrono::steady_clock;
+    const auto tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tickSeconds));
+    auto nextTick = Clock::now();
+    while (running)
+    {
+        Tick();
+
+        // Catch up on a few missed ticks, but after a long stall (e.g. streaming in a new area) just carry on from now
+        nextTick += tickDuration;
+        if (const auto now = Clock::now(); now - nextTick > tickDuration * maxCatchUpTicks)
+            nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+void Core::Tick()
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<BlockEdit> edits;
+    Vector3 position;
+    {
+        std::lock_guard lock(inputMutex);
+        edits.swap(pendingEdits);
+        position = playerPosition;
+    }
+
+    for (const auto& [origin, direction, place] : edits)
+    {
+        std::array<int, 3> hit {}, previous {};
+        if (!world.RaycastBlock(origin, direction, reachDistance, hit, previous))
+            continue;
+
+        if (place)
+            world.SetBlockAt(previous[0], previous[1], previous[2], 4);
+        else
+            world.SetBlockAt(hit[0], hit[1], hit[2], 0);
+    }
+
+    world.Update(position);
+    world.PublishSnapshot();
+    tickMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
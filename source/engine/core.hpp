@@ -1,5 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <framegovernor.hpp>
 #include <world.hpp>
 
 #include "raylib.h"
@@ -7,13 +15,46 @@
 class Core
 {
     public:
-        Core();
+        explicit Core(const std::filesystem::path& saveDirectory = "world");
         ~Core();
 
+        // Main thread: camera and input, edits are handed to the simulation
         void Update(float deltaTime);
-        void Render() const;
+        void Render();
+
+        // For runs without input, e.g. headless ones; takes effect with the next Update
+        void SetCamera(Vector3 position, Vector3 target);
+        [[nodiscard]] const World& GetWorld() const;
+        [[nodiscard]] const FrameGovernor& GetGovernor() const;
     private:
+        // Block edits picked on the main thread, raycast and applied on the simulation thread
+        struct BlockEdit
+        {
+            Vector3 origin, direction;
+            bool place = false; // Place stone in front of the hit block instead of breaking it
+        };
+
         Camera3D camera;
+        const float reachDistance = 6.0f;
+        const double tickSeconds = 1.0 / 30.0;
+        const int maxCatchUpTicks = 4; // Ticks run back to back after a stall before the schedule is reset
+        bool showDebugInfo = false; // F3 toggles the stats overlay and printing the governor's decisions
 
         World world;
-};
\ No newline at end of file
+        FrameGovernor governor;
+        std::chrono::steady_clock::time_point frameStart;
+        double workMilliseconds = 0; // Of the last frame, up to presenting it
+
+        // Handed from the main thread to the simulation thread
+        std::mutex inputMutex;
+        std::vector<BlockEdit> pendingEdits;
+        Vector3 playerPosition;
+
+        std::atomic<double> tickMilliseconds = 0; // Duration of the latest tick
+
+        std::atomic<bool> running = true;
+        std::thread simulationThread; // Started last, once everything it touches exists
+
+        void RunSimulation();
+        void Tick();
+};
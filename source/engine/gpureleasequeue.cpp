@@ -0,0 +1,20 @@
+#include "gpureleasequeue.hpp"
+
+void GpuReleaseQueue::Defer(std::function<void()> release)
+{
+    std::lock_guard lock(mutex);
+    pending.push_back(std::move(release));
+}
+
+void GpuReleaseQueue::Flush()
+{
+    // Swap the list out first, releases must not run while holding the lock
+    std::vector<std::function<void()>> releases;
+    {
+        std::lock_guard lock(mutex);
+        releases.swap(pending);
+    }
+
+    for (const auto& release : releases)
+        release();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Collects GPU resources dropped on any thread, so they are only ever freed on the render thread
+class GpuReleaseQueue
+{
+    public:
+        GpuReleaseQueue() = default;
+
+        void Defer(std::function<void()> release);
+
+        // Runs every deferred release; render thread only
+        void Flush();
+    private:
+        std::vector<std::function<void()>> pending;
+        std::mutex mutex;
+};
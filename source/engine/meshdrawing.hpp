@@ -0,0 +1,9 @@
+#pragma once
+
+// Contiguous run of vertices inside a mesh
+struct MeshRange
+{
+    int firstVertex = 0;
+    int vertexCount = 0;
+};
+
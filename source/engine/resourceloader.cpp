@@ -4,6 +4,9 @@
 
 #include "resourceloader.hpp"
 
+#include "backend.hpp"
+#include "tileatlas.hpp"
+
 ResourceLoader::ResourceLoader() = default;
 
 ResourceLoader::~ResourceLoader()
@@ -23,7 +26,7 @@ void ResourceLoader::UnloadAssets()
     // Clear textures
     for (const auto& p : this->Textures2D | std::views::values)
     {
-        UnloadTexture(p);
+        Backend::UnloadTexture(p);
     }
     this->Textures2D.clear();
 
@@ -37,7 +40,7 @@ void ResourceLoader::UnloadAssets()
     // Clear shaders
     for (const auto& p : this->Shaders | std::views::values)
     {
-        UnloadShader(p);
+        Backend::UnloadShader(p);
     }
 
     // Clear sounds
@@ -50,7 +53,7 @@ void ResourceLoader::UnloadAssets()
     // Clear music
     for (const auto& p : this->Musics | std::views::values)
     {
-        UnloadMusicStream(p);
+        Backend::UnloadMusicStream(p);
     }
     this->Musics.clear();
 }
@@ -74,12 +77,25 @@ Texture2D ResourceLoader::GetTexture2D(const std::string& path)
     {
         this->Textures2D.insert(std::pair(
             path,
-            LoadTexture((ASSETS_PATH + path).c_str())
+            Backend::LoadTexture((ASSETS_PATH + path).c_str())
         ));
     }
     return this->Textures2D[path];
 }
 
+Texture2D ResourceLoader::GetTileAtlas(const std::string& path, const int tilesX, const int tilesY)
+{
+    const std::string key = path + "|" + std::to_string(tilesX) + "x" + std::to_string(tilesY);
+    if (!this->Textures2D.contains(key)) // No atlas, build its mip chain and load it
+    {
+        this->Textures2D.insert(std::pair(
+            key,
+            TileAtlas::LoadTexture(GetImage(path), tilesX, tilesY)
+        ));
+    }
+    return this->Textures2D[key];
+}
+
 Model ResourceLoader::GetModel(const std::string& path)
 {
     if (!this->Models.contains(path)) // No texture, load it
@@ -98,12 +114,25 @@ Shader ResourceLoader::GetShader(const std::string& path)
     {
         this->Shaders.insert(std::pair(
             path,
-            LoadShader(nullptr, (ASSETS_PATH + path).c_str())
+            Backend::LoadShader(nullptr, (ASSETS_PATH + path).c_str())
         ));
     }
     return this->Shaders[path];
 }
 
+Shader ResourceLoader::GetShader(const std::string& vertexPath, const std::string& fragmentPath)
+{
+    const std::string key = vertexPath + "|" + fragmentPath;
+    if (!this->Shaders.contains(key))
+    {
+        this->Shaders.insert(std::pair(
+            key,
+            Backend::LoadShader((ASSETS_PATH + vertexPath).c_str(), (ASSETS_PATH + fragmentPath).c_str())
+        ));
+    }
+    return this->Shaders[key];
+}
+
 Sound ResourceLoader::GetSound(const std::string& path)
 {
     if (!this->Sounds.contains(path)) // No sound, load it
@@ -122,7 +151,7 @@ Music ResourceLoader::GetMusic(const std::string& path)
     {
         this->Musics.insert(std::pair<std::string, Music>(
             path,
-            LoadMusicStream((ASSETS_PATH + path).c_str())
+            Backend::LoadMusicStream((ASSETS_PATH + path).c_str())
         ));
     }
     return this->Musics[path];
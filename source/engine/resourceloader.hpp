@@ -16,8 +16,10 @@ public:
 
     Image GetImage(const std::string& path);
     Texture2D GetTexture2D(const std::string& path);
+    Texture2D GetTileAtlas(const std::string& path, int tilesX, int tilesY);
     Model GetModel(const std::string& path);
     Shader GetShader(const std::string& path);
+    Shader GetShader(const std::string& vertexPath, const std::string& fragmentPath);
     Sound GetSound(const std::string& path);
     Music GetMusic(const std::string& path);
 private:
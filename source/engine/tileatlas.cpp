@@ -0,0 +1,195 @@
+#include "tileatlas.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "backend.hpp"
+#include "rlgl.h"
+
+namespace TileAtlas
+{
+    constexpr int bytesPerPixel = 4;
+    constexpr int alphaCutoff = 127; // Cutout shaders discard alpha <= 0.5
+
+    int GetTileLevelCount(int tileWidth, int tileHeight)
+    {
+        int levels = 1;
+        while (tileWidth > 1 && tileHeight > 1 && tileWidth % 2 == 0 && tileHeight % 2 == 0)
+        {
+            tileWidth /= 2;
+            tileHeight /= 2;
+            levels++;
+        }
+
+        return levels;
+    }
+
+    static int GetLevelCount(const int width, const int height)
+    {
+        return static_cast<int>(std::floor(std::log2(std::max(width, height)))) + 1;
+    }
+
+    size_t GetLevelOffset(const int width, const int height, const int level)
+    {
+        size_t offset = 0;
+        for (int i = 0; i < level; i++)
+            offset += static_cast<size_t>(std::max(width >> i, 1)) * std::max(height >> i, 1) * bytesPerPixel;
+        return offset;
+    }
+
+    // Average of a block of source texels, with colors weighted by alpha so clear texels don't tint their neighbors
+    static std::array<unsigned char, 4> Average(const unsigned char* source, const int sourceWidth, const int x, const int y, const int countX, const int countY)
+    {
+        std::array<int, 4> sum {};
+        for (int dy = 0; dy < countY; dy++)
+        {
+            for (int dx = 0; dx < countX; dx++)
+            {
+                const unsigned char* texel = source + ((y + dy) * sourceWidth + x + dx) * bytesPerPixel;
+                for (int c = 0; c < 3; c++)
+                    sum[c] += texel[c] * texel[3];
+                sum[3] += texel[3];
+            }
+        }
+
+        std::array<unsigned char, 4> result {};
+        const int count = countX * countY;
+        for (int c = 0; c < 3; c++)
+        {
+            // Fully clear blocks keep a plain average, there is no weight to go by
+            if (sum[3] > 0)
+            {
+                result[c] = static_cast<unsigned char>((sum[c] + sum[3] / 2) / sum[3]);
+            }
+            else
+            {
+                int plain = 0;
+                for (int dy = 0; dy < countY; dy++)
+                    for (int dx = 0; dx < countX; dx++)
+                        plain += source[((y + dy) * sourceWidth + x + dx) * bytesPerPixel + c];
+                result[c] = static_cast<unsigned char>((plain + count / 2) / count);
+            }
+        }
+        result[3] = static_cast<unsigned char>((sum[3] + count / 2) / count);
+
+        return result;
+    }
+
+    static unsigned char ScaleAlpha(const unsigned char alpha, const float scale)
+    {
+        return static_cast<unsigned char>(std::min(std::lround(alpha * scale), 255l));
+    }
+
+    static int CountCovered(const unsigned char* level, const int levelWidth, const int x, const int y, const int width, const int height, const float alphaScale)
+    {
+        int covered = 0;
+        for (int ty = y; ty < y + height; ty++)
+            for (int tx = x; tx < x + width; tx++)
+                covered += ScaleAlpha(level[(ty * levelWidth + tx) * bytesPerPixel + 3], alphaScale) > alphaCutoff;
+        return covered;
+    }
+
+    std::vector<unsigned char> BuildMipChain(const unsigned char* pixels, const int width, const int height, const int tilesX, const int tilesY)
+    {
+        const int levels = GetLevelCount(width, height);
+        const int tileWidth = width / tilesX, tileHeight = height / tilesY;
+        const int tileLevels = std::min(GetTileLevelCount(tileWidth, tileHeight), levels);
+
+        std::vector<unsigned char> chain(GetLevelOffset(width, height, levels));
+        std::copy_n(pixels, static_cast<size_t>(width) * height * bytesPerPixel, chain.begin());
+
+        // Share of every tile that survives the alpha cutoff at full size
+        std::vector<float> coverage(tilesX * tilesY);
+        for (int tile = 0; tile < tilesX * tilesY; tile++)
+        {
+            const int covered = CountCovered(pixels, width, tile % tilesX * tileWidth, tile / tilesX * tileHeight, tileWidth, tileHeight, 1.0f);
+            coverage[tile] = static_cast<float>(covered) / static_cast<float>(tileWidth * tileHeight);
+        }
+
+        for (int level = 1; level < levels; level++)
+        {
+            const unsigned char* source = chain.data() + GetLevelOffset(width, height, level - 1);
+            unsigned char* target = chain.data() + GetLevelOffset(width, height, level);
+            const int sourceWidth = std::max(width >> (level - 1), 1), sourceHeight = std::max(height >> (level - 1), 1);
+            const int targetWidth = std::max(width >> level, 1), targetHeight = std::max(height >> level, 1);
+
+            // Past one texel per tile, tiles can't be kept apart anymore. Just complete the chain.
+            if (level >= tileLevels)
+            {
+                for (int y = 0; y < targetHeight; y++)
+                {
+                    for (int x = 0; x < targetWidth; x++)
+                    {
+                        const int countX = std::min(2, sourceWidth - x * 2), countY = std::min(2, sourceHeight - y * 2);
+                        const auto texel = Average(source, sourceWidth, x * 2, y * 2, countX, countY);
+                        std::copy(texel.begin(), texel.end(), target + (y * targetWidth + x) * bytesPerPixel);
+                    }
+                }
+                continue;
+            }
+
+            const int levelTileWidth = tileWidth >> level, levelTileHeight = tileHeight >> level;
+            for (int tile = 0; tile < tilesX * tilesY; tile++)
+            {
+                const int tileX = tile % tilesX * levelTileWidth, tileY = tile / tilesX * levelTileHeight;
+                for (int y = tileY; y < tileY + levelTileHeight; y++)
+                {
+                    for (int x = tileX; x < tileX + levelTileWidth; x++)
+                    {
+                        const auto texel = Average(source, sourceWidth, x * 2, y * 2, 2, 2);
+                        std::copy(texel.begin(), texel.end(), target + (y * targetWidth + x) * bytesPerPixel);
+                    }
+                }
+
+                // Averaging thins out cutouts with every level, scale alpha back up until the tile covers as much as at full size
+                if (coverage[tile] <= 0.0f || coverage[tile] >= 1.0f)
+                    continue;
+
+                const int wanted = std::max(static_cast<int>(std::lround(coverage[tile] * static_cast<float>(levelTileWidth * levelTileHeight))), 1);
+                float low = 0.0f, high = 8.0f;
+                for (int step = 0; step < 16; step++)
+                {
+                    const float middle = (low + high) / 2;
+                    if (CountCovered(target, targetWidth, tileX, tileY, levelTileWidth, levelTileHeight, middle) < wanted)
+                        low = middle;
+                    else
+                        high = middle;
+                }
+
+                // Equal alphas make coverage jump in steps, take whichever side lands closer but never let a cutout vanish
+                const int coveredLow = CountCovered(target, targetWidth, tileX, tileY, levelTileWidth, levelTileHeight, low);
+                const int coveredHigh = CountCovered(target, targetWidth, tileX, tileY, levelTileWidth, levelTileHeight, high);
+                const float scale = coveredLow > 0 && wanted - coveredLow < coveredHigh - wanted ? low : high;
+
+                for (int y = tileY; y < tileY + levelTileHeight; y++)
+                {
+                    for (int x = tileX; x < tileX + levelTileWidth; x++)
+                    {
+                        unsigned char& alpha = target[(y * targetWidth + x) * bytesPerPixel + 3];
+                        alpha = ScaleAlpha(alpha, scale);
+                    }
+                }
+            }
+        }
+
+        return chain;
+    }
+
+    Texture2D LoadTexture(const Image& atlas, const int tilesX, const int tilesY)
+    {
+        Image rgba = ImageCopy(atlas);
+        ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        std::vector<unsigned char> chain = BuildMipChain(static_cast<const unsigned char*>(rgba.data), rgba.width, rgba.height, tilesX, tilesY);
+
+        const Image mipmapped = {chain.data(), rgba.width, rgba.height, GetLevelCount(rgba.width, rgba.height), PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        const Texture2D texture = Backend::LoadTextureFromImage(mipmapped);
+        UnloadImage(rgba);
+
+        // Crisp texels up close, blended levels in the distance
+        Backend::SetTextureParameter(texture.id, RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_NEAREST);
+        Backend::SetTextureParameter(texture.id, RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_NEAREST_MIP_LINEAR);
+
+        return texture;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "raylib.h"
+
+// Mipmapped atlas of equally sized tiles. Levels are built on the CPU one tile at a time, so no level mixes
+// neighboring tiles and it can be checked without a GPU.
+namespace TileAtlas
+{
+    // Levels that still keep tiles apart, from full size down to one texel per tile
+    [[nodiscard]] int GetTileLevelCount(int tileWidth, int tileHeight);
+
+    // Full mip chain of an RGBA8 atlas of tilesX * tilesY tiles, every level back to back the way raylib loads them.
+    // Colors are averaged weighted by alpha, and alpha is rescaled per tile so cutouts cover as much at every level.
+    // Levels past GetTileLevelCount only complete the chain and must not be sampled.
+    [[nodiscard]] std::vector<unsigned char> BuildMipChain(const unsigned char* pixels, int width, int height, int tilesX, int tilesY);
+
+    // Byte offset of a level inside the chain
+    [[nodiscard]] size_t GetLevelOffset(int width, int height, int level);
+
+    // Uploads the atlas with its mip chain, nearest filtered up close and blending levels further away
+    [[nodiscard]] Texture2D LoadTexture(const Image& atlas, int tilesX, int tilesY);
+}
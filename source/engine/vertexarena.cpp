@@ -0,0 +1,291 @@
+#include "vertexarena.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include "backend.hpp"
+#include "raymath.h"
+#include "rlgl.h"
+
+ArenaAllocator::ArenaAllocator(const int capacity) : capacity(capacity)
+{
+    Reset(capacity);
+}
+
+int ArenaAllocator::Allocate(const int vertexCount)
+{
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        const auto [firstVertex, blockCount] = *it;
+        if (blockCount < vertexCount)
+            continue;
+
+        // Take the front of the block, the rest stays free
+        freeBlocks.erase(it);
+        if (blockCount > vertexCount)
+            freeBlocks[firstVertex + vertexCount] = blockCount - vertexCount;
+
+        used += vertexCount;
+        return firstVertex;
+    }
+
+    return -1;
+}
+
+void ArenaAllocator::Free(const int firstVertex, const int vertexCount)
+{
+    if (vertexCount <= 0)
+        return;
+
+    used -= vertexCount;
+    auto [it, inserted] = freeBlocks.emplace(firstVertex, vertexCount);
+
+    // Merge with the following block, then with the preceding one
+    if (const auto next = std::next(it); next != freeBlocks.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        freeBlocks.erase(next);
+    }
+    if (it != freeBlocks.begin())
+    {
+        if (const auto previous = std::prev(it); previous->first + previous->second == it->first)
+        {
+            previous->second += it->second;
+            freeBlocks.erase(it);
+        }
+    }
+}
+
+void ArenaAllocator::Reset(const int capacity)
+{
+    this->capacity = capacity;
+    used = 0;
+    freeBlocks.clear();
+    freeBlocks[0] = capacity;
+}
+
+void ArenaAllocator::Extend(const int capacity)
+{
+    // Merge the new room with a free block that reaches the old end
+    const int added = capacity - this->capacity;
+    if (!freeBlocks.empty() && std::prev(freeBlocks.end())->first + std::prev(freeBlocks.end())->second == this->capacity)
+        std::prev(freeBlocks.end())->second += added;
+    else
+        freeBlocks[this->capacity] = added;
+    this->capacity = capacity;
+}
+
+int ArenaAllocator::GetCapacity() const
+{
+    return capacity;
+}
+
+int ArenaAllocator::GetUsed() const
+{
+    return used;
+}
+
+int ArenaAllocator::GetLargestFreeBlock() const
+{
+    int largest = 0;
+    for (const int count : freeBlocks | std::views::values)
+        largest = std::max(largest, count);
+
+    return largest;
+}
+
+VertexArena::VertexArena(const int initialCapacity) : allocator(initialCapacity)
+{}
+
+VertexArena::~VertexArena()
+{
+    UnloadBuffers();
+}
+
+VertexArena::Allocation VertexArena::Allocate(const int vertexCount)
+{
+    // Empty meshes get an empty but valid allocation, so they aren't uploaded again every frame
+    if (vertexCount == 0)
+        return {0, 0, generation};
+
+    const int firstVertex = allocator.Allocate(vertexCount);
+    if (firstVertex < 0)
+        return {};
+
+    return {firstVertex, vertexCount, generation};
+}
+
+void VertexArena::Free(Allocation& allocation)
+{
+    if (IsValid(allocation))
+        allocator.Free(allocation.firstVertex, allocation.vertexCount);
+
+    allocation = {};
+}
+
+bool VertexArena::IsValid(const Allocation& allocation) const
+{
+    return allocation.firstVertex >= 0 && allocation.generation == generation;
+}
+
+void VertexArena::Grow()
+{
+    const int capacity = allocator.GetCapacity();
+    if (vaoId == 0)
+    {
+        // Nothing on the GPU yet, the buffers are created at the new size
+        allocator.Extend(capacity * 2);
+        return;
+    }
+
+    if (!Backend::CanCopyVertexBuffers())
+    {
+        // The owners upload their meshes again
+        UnloadBuffers();
+        allocator.Reset(capacity * 2);
+        generation++;
+        return;
+    }
+
+    // Everything stays where it is in the new buffers, so meshes keep drawing without being uploaded again
+    const unsigned int oldVaoId = vaoId;
+    const std::array<unsigned int, 4> oldVboIds = vboIds;
+    allocator.Extend(capacity * 2);
+    LoadBuffers();
+    constexpr std::array<int, 4> vertexBytes = {3 * sizeof(float), 2 * sizeof(float), 3 * sizeof(float), 4 * sizeof(unsigned char)};
+    for (size_t i = 0; i < vboIds.size(); i++)
+    {
+        Backend::CopyVertexBuffer(oldVboIds[i], vboIds[i], capacity * vertexBytes[i]);
+        Backend::UnloadVertexBuffer(oldVboIds[i]);
+    }
+    Backend::UnloadVertexArray(oldVaoId);
+}
+
+void VertexArena::Upload(const Allocation& allocation, const Mesh& mesh, const int firstVertex, const int vertexCount, const Vector3 offset)
+{
+    if (!IsValid(allocation) || vertexCount == 0)
+        return;
+
+    // Buffers are created on first use, after the window (and GL context) exists, and again after growing
+    if (vaoId == 0)
+        LoadBuffers();
+
+    movedPositions.resize(vertexCount * 3);
+    for (int i = 0; i < vertexCount; i++)
+    {
+        movedPositions[i * 3] = mesh.vertices[(firstVertex + i) * 3] + offset.x;
+        movedPositions[i * 3 + 1] = mesh.vertices[(firstVertex + i) * 3 + 1] + offset.y;
+        movedPositions[i * 3 + 2] = mesh.vertices[(firstVertex + i) * 3 + 2] + offset.z;
+    }
+
+    const int target = allocation.firstVertex + firstVertex;
+    Backend::UpdateVertexBuffer(vboIds[0], movedPositions.data(), vertexCount * 3 * sizeof(float), target * 3 * sizeof(float));
+    Backend::UpdateVertexBuffer(vboIds[1], mesh.texcoords + firstVertex * 2, vertexCount * 2 * sizeof(float), target * 2 * sizeof(float));
+    Backend::UpdateVertexBuffer(vboIds[2], mesh.normals + firstVertex * 3, vertexCount * 3 * sizeof(float), target * 3 * sizeof(float));
+    Backend::UpdateVertexBuffer(vboIds[3], mesh.colors + firstVertex * 4, vertexCount * 4 * sizeof(unsigned char), target * 4 * sizeof(unsigned char));
+}
+
+void VertexArena::Begin(const Material& material)
+{
+    if (vaoId == 0)
+        LoadBuffers();
+
+    Backend::EnableShader(material.shader.id);
+
+    if (material.shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+    {
+        const Color color = material.maps[MATERIAL_MAP_DIFFUSE].color;
+        const float values[4] = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+        Backend::SetUniform(material.shader.locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    // One matrix for all meshes, their vertices are in world space already
+    const Matrix matModel = rlGetMatrixTransform();
+    Backend::SetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(MatrixMultiply(matModel, rlGetMatrixModelview()), rlGetMatrixProjection()));
+
+    constexpr int textureSlot = 0;
+    Backend::ActiveTextureSlot(textureSlot);
+    Backend::EnableTexture(material.maps[MATERIAL_MAP_ALBEDO].texture.id);
+    Backend::SetUniform(material.shader.locs[SHADER_LOC_MAP_ALBEDO], &textureSlot, SHADER_UNIFORM_INT, 1);
+
+    Backend::EnableVertexArray(vaoId);
+    drawFirstVertices.clear();
+    drawVertexCounts.clear();
+}
+
+void VertexArena::Draw(const Allocation& allocation, const std::vector<MeshRange>& ranges)
+{
+    if (!IsValid(allocation) || allocation.vertexCount == 0)
+        return;
+
+    // Ranges that continue where the previous one ended, also across meshes, become one
+    for (const auto& [firstVertex, vertexCount] : ranges)
+    {
+        const int first = allocation.firstVertex + firstVertex;
+        if (!drawFirstVertices.empty() && drawFirstVertices.back() + drawVertexCounts.back() == first)
+        {
+            drawVertexCounts.back() += vertexCount;
+            continue;
+        }
+        drawFirstVertices.push_back(first);
+        drawVertexCounts.push_back(vertexCount);
+    }
+}
+
+void VertexArena::End()
+{
+    if (!drawFirstVertices.empty())
+        Backend::MultiDrawVertexArray(drawFirstVertices.data(), drawVertexCounts.data(), static_cast<int>(drawFirstVertices.size()));
+
+    Backend::DisableVertexArray();
+
+    Backend::ActiveTextureSlot(0);
+    Backend::DisableTexture();
+    Backend::DisableShader();
+}
+
+const ArenaAllocator& VertexArena::GetAllocator() const
+{
+    return allocator;
+}
+
+void VertexArena::LoadBuffers()
+{
+    const int capacity = allocator.GetCapacity();
+
+    vaoId = Backend::LoadVertexArray();
+    Backend::EnableVertexArray(vaoId);
+
+    // Same attribute layout as raylib's own meshes, so the default shader locations apply
+    vboIds[0] = Backend::LoadVertexBuffer(nullptr, capacity * 3 * sizeof(float), true);
+    Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, 0, 0);
+    Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+    vboIds[1] = Backend::LoadVertexBuffer(nullptr, capacity * 2 * sizeof(float), true);
+    Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, 0, 0);
+    Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+
+    vboIds[2] = Backend::LoadVertexBuffer(nullptr, capacity * 3 * sizeof(float), true);
+    Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, false, 0, 0);
+    Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+
+    vboIds[3] = Backend::LoadVertexBuffer(nullptr, capacity * 4 * sizeof(unsigned char), true);
+    Backend::SetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+    Backend::EnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+
+    Backend::DisableVertexBuffer();
+    Backend::DisableVertexArray();
+}
+
+void VertexArena::UnloadBuffers()
+{
+    if (vaoId != 0)
+        Backend::UnloadVertexArray(vaoId);
+    for (unsigned int& vboId : vboIds)
+    {
+        if (vboId != 0)
+            Backend::UnloadVertexBuffer(vboId);
+        vboId = 0;
+    }
+    vaoId = 0;
+}
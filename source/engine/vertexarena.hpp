@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "raylib.h"
+#include "meshdrawing.hpp"
+
+// First-fit sub-allocator handing out vertex ranges of a fixed capacity; CPU only, so it can be exercised without a GPU
+class ArenaAllocator
+{
+    public:
+        explicit ArenaAllocator(int capacity);
+
+        // Returns the first vertex of the new range, or -1 if no free block is large enough
+        [[nodiscard]] int Allocate(int vertexCount);
+        void Free(int firstVertex, int vertexCount);
+        void Reset(int capacity);
+        void Extend(int capacity); // Adds free room at the end, allocations stay
+
+        [[nodiscard]] int GetCapacity() const;
+        [[nodiscard]] int GetUsed() const;
+        [[nodiscard]] int GetLargestFreeBlock() const;
+    private:
+        int capacity;
+        int used = 0;
+        std::map<int, int> freeBlocks; // First vertex to vertex count, neighbors are always merged
+};
+
+// One big set of vertex buffers and a single vertex array shared by many meshes, so drawing them
+// needs no per-mesh buffer binds, material setup or CPU-side transform matrices
+class VertexArena
+{
+    public:
+        struct Allocation
+        {
+            int firstVertex = -1;
+            int vertexCount = 0;
+            unsigned int generation = 0; // Allocations from before the arena last grew are gone
+        };
+
+        explicit VertexArena(int initialCapacity);
+        ~VertexArena();
+
+        [[nodiscard]] Allocation Allocate(int vertexCount);
+        void Free(Allocation& allocation);
+        [[nodiscard]] bool IsValid(const Allocation& allocation) const;
+
+        // Doubles the capacity. The contents are copied over on the GPU and allocations stay valid, unless the backend
+        // can't copy buffers: then every allocation becomes invalid and has to be uploaded again.
+        void Grow();
+
+        // Copies vertices [firstVertex, firstVertex + vertexCount) of the mesh to the same place inside the allocation,
+        // with offset added to every position so meshes sit in world space and need no transform of their own
+        void Upload(const Allocation& allocation, const Mesh& mesh, int firstVertex, int vertexCount, Vector3 offset);
+
+        // Ranges drawn between Begin and End are collected, End draws them all with one multi-draw
+        void Begin(const Material& material);
+        void Draw(const Allocation& allocation, const std::vector<MeshRange>& ranges);
+        void End();
+
+        [[nodiscard]] const ArenaAllocator& GetAllocator() const;
+    private:
+        ArenaAllocator allocator;
+        unsigned int generation = 1;
+
+        unsigned int vaoId = 0;
+        std::array<unsigned int, 4> vboIds {}; // Positions, texcoords, normals, colors
+
+        std::vector<int> drawFirstVertices, drawVertexCounts; // Collected since Begin
+        std::vector<float> movedPositions; // Scratch for uploads
+
+        void LoadBuffers();
+        void UnloadBuffers();
+};
@@ -0,0 +1,315 @@
+#include "farterrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "backend.hpp"
+#include "raymath.h"
+
+FarTerrain::FarTerrain(SurfaceSampler surface) : surface(std::move(surface))
+{
+    worker = std::thread(&FarTerrain::RunWorker, this);
+}
+
+FarTerrain::~FarTerrain()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    for (TileBuild& build : finished)
+    {
+        FreeVertexArrays(build.mesh);
+        MemFree(build.mesh.indices);
+    }
+    for (auto& [key, tile] : tiles)
+    {
+        Mesh mesh = tile.mesh;
+        Backend::UnloadMesh(mesh);
+    }
+}
+
+void FarTerrain::Load(const Shader shader, const Texture2D texture, const Vector2 surfaceTexcoord)
+{
+    material = Backend::LoadMaterialDefault();
+    material.shader = shader;
+    SetMaterialTexture(&material, MATERIAL_MAP_ALBEDO, texture);
+    this->surfaceTexcoord = surfaceTexcoord;
+
+    realMinLocation = Backend::GetShaderLocation(shader, "realMin");
+    realMaxLocation = Backend::GetShaderLocation(shader, "realMax");
+    cameraLocation = Backend::GetShaderLocation(shader, "cameraPosition");
+
+    // Fade out well before the last tiles, whichever way the camera faces
+    const Vector2 fogRange = {tileBlocks * (tileRadius - 2.0f), tileBlocks * static_cast<float>(tileRadius)};
+    const Vector4 fogColor = ColorNormalize(SKYBLUE);
+    Backend::SetShaderValue(shader, Backend::GetShaderLocation(shader, "fogRange"), &fogRange, SHADER_UNIFORM_VEC2);
+    Backend::SetShaderValue(shader, Backend::GetShaderLocation(shader, "fogColor"), &fogColor, SHADER_UNIFORM_VEC4);
+}
+
+void FarTerrain::Draw(const Vector3 cameraPos, const BoundingBox realChunks)
+{
+    frame++;
+    const int cameraTileX = static_cast<int>(std::floor(cameraPos.x / tileBlocks));
+    const int cameraTileZ = static_cast<int>(std::floor(cameraPos.z / tileBlocks));
+
+    // Tiles around the camera's, nearest first
+    static const std::vector<std::pair<int, int>> offsets = []
+    {
+        std::vector<std::pair<int, int>> result;
+        for (int dx = -tileRadius; dx <= tileRadius; dx++)
+            for (int dz = -tileRadius; dz <= tileRadius; dz++)
+                result.emplace_back(dx, dz);
+        std::ranges::stable_sort(result, {}, [](const auto& offset) { return std::max(std::abs(offset.first), std::abs(offset.second)); });
+        return result;
+    }();
+
+    std::vector<Request> wanted;
+    for (const auto& [dx, dz] : offsets)
+    {
+        const int cells = GetCellsAt(std::max(std::abs(dx), std::abs(dz)));
+        const auto it = tiles.find(GetKey(cameraTileX + dx, cameraTileZ + dz));
+        if (it == tiles.end() || it->second.cells != cells)
+            wanted.push_back({cameraTileX + dx, cameraTileZ + dz, cells});
+    }
+
+    // Take a few finished tiles and hand the worker whatever is still missing, minus what it already has done or underway
+    std::vector<TileBuild> ready;
+    {
+        std::lock_guard lock(mutex);
+        const auto readyEnd = finished.begin() + std::min(finished.size(), static_cast<size_t>(uploadsPerFrame));
+        ready.assign(std::make_move_iterator(finished.begin()), std::make_move_iterator(readyEnd));
+        finished.erase(finished.begin(), readyEnd);
+
+        requests.clear();
+        for (const Request& request : wanted)
+        {
+            const auto matches = [&](const int tileX, const int tileZ, const int cells)
+            {
+                return tileX == request.tileX && tileZ == request.tileZ && cells == request.cells;
+            };
+            if (building && matches(building->tileX, building->tileZ, building->cells))
+                continue;
+            if (std::ranges::any_of(finished, [&](const TileBuild& build) { return matches(build.tileX, build.tileZ, build.cells); }))
+                continue;
+            if (std::ranges::any_of(ready, [&](const TileBuild& build) { return matches(build.tileX, build.tileZ, build.cells); }))
+                continue;
+            requests.push_back(request);
+        }
+    }
+    wake.notify_one();
+
+    // A new build replaces the tile's old one, which stays drawn until then
+    for (TileBuild& build : ready)
+    {
+        Backend::UploadMesh(&build.mesh, false);
+        FreeVertexArrays(build.mesh);
+
+        Tile& tile = tiles[GetKey(build.tileX, build.tileZ)];
+        if (tile.mesh.vaoId != 0)
+            Backend::UnloadMesh(tile.mesh);
+        tile = {build.cells, build.mesh, build.minHeight, build.maxHeight, build.skirtDepth, frame};
+    }
+
+    const Shader& shader = material.shader;
+    Backend::SetShaderValue(shader, realMinLocation, &realChunks.min, SHADER_UNIFORM_VEC3);
+    Backend::SetShaderValue(shader, realMaxLocation, &realChunks.max, SHADER_UNIFORM_VEC3);
+    Backend::SetShaderValue(shader, cameraLocation, &cameraPos, SHADER_UNIFORM_VEC3);
+    for (const auto& [dx, dz] : offsets)
+    {
+        const int tileX = cameraTileX + dx, tileZ = cameraTileZ + dz;
+        const auto it = tiles.find(GetKey(tileX, tileZ));
+        if (it == tiles.end())
+            continue;
+        it.value().lastUsed = frame;
+
+        // Tiles whose whole surface lies inside the real chunks would only be discarded fragment by fragment
+        const Tile& tile = it->second;
+        const Vector3 min = {static_cast<float>(tileX * tileBlocks), static_cast<float>(tile.minHeight - tile.skirtDepth), static_cast<float>(tileZ * tileBlocks)};
+        const Vector3 max = {min.x + tileBlocks, static_cast<float>(tile.maxHeight), min.z + tileBlocks};
+        if (min.x >= realChunks.min.x && min.y >= realChunks.min.y && min.z >= realChunks.min.z &&
+            max.x <= realChunks.max.x && max.y < realChunks.max.y && max.z <= realChunks.max.z)
+            continue;
+
+        Backend::DrawMesh(tile.mesh, material, MatrixTranslate(min.x, 0, min.z));
+    }
+
+    // Drop the tiles gone unused the longest
+    while (tiles.size() > maxCachedTiles)
+    {
+        const auto oldest = std::ranges::min_element(tiles, {}, [](const auto& entry) { return entry.second.lastUsed; });
+        Mesh mesh = oldest->second.mesh;
+        Backend::UnloadMesh(mesh);
+        tiles.erase(oldest);
+    }
+}
+
+int FarTerrain::GetCellsAt(const int tileDistance)
+{
+    if (tileDistance <= 1)
+        return tileCells[0];
+    return tileDistance <= 3 ? tileCells[1] : tileCells[2];
+}
+
+FarTerrain::TileBuild FarTerrain::BuildTile(const SurfaceSampler& surface, const int tileX, const int tileZ, const int cells, const Vector2 texcoord)
+{
+    const int spacing = tileBlocks / cells;
+    const int side = cells + 1;
+    const int originX = tileX * tileBlocks, originZ = tileZ * tileBlocks;
+
+    // Sampled one step past the tile on every side, so shading is continuous across tile borders
+    std::vector<int> heights((side + 2) * (side + 2));
+    const auto heightAt = [&](const int i, const int j) -> int& { return heights[(i + 1) * (side + 2) + j + 1]; };
+    for (int i = -1; i <= side; i++)
+        for (int j = -1; j <= side; j++)
+            heightAt(i, j) = surface(originX + i * spacing, originZ + j * spacing);
+
+    TileBuild result {tileX, tileZ, cells};
+    Mesh& mesh = result.mesh;
+    mesh.vertexCount = side * side + 4 * side;
+    mesh.triangleCount = cells * cells * 2 + 4 * cells * 4;
+    mesh.vertices = static_cast<float*>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
+    mesh.texcoords = static_cast<float*>(MemAlloc(mesh.vertexCount * 2 * sizeof(float)));
+    mesh.colors = static_cast<unsigned char*>(MemAlloc(mesh.vertexCount * 4 * sizeof(unsigned char)));
+    mesh.indices = static_cast<unsigned short*>(MemAlloc(mesh.triangleCount * 3 * sizeof(unsigned short)));
+
+    int vertex = 0;
+    const auto addVertex = [&](const int i, const int j, const int height)
+    {
+        // Slopes are shaded a little darker, flat ground is as bright as the top faces of real blocks
+        const float slopeX = static_cast<float>(heightAt(i + 1, j) - heightAt(i - 1, j)) / (2.0f * spacing);
+        const float slopeZ = static_cast<float>(heightAt(i, j + 1) - heightAt(i, j - 1)) / (2.0f * spacing);
+        const auto brightness = static_cast<unsigned char>(255 * (0.75f + 0.25f / std::sqrt(1 + slopeX * slopeX + slopeZ * slopeZ)));
+
+        mesh.vertices[vertex * 3] = static_cast<float>(i * spacing);
+        mesh.vertices[vertex * 3 + 1] = static_cast<float>(height);
+        mesh.vertices[vertex * 3 + 2] = static_cast<float>(j * spacing);
+        mesh.texcoords[vertex * 2] = texcoord.x;
+        mesh.texcoords[vertex * 2 + 1] = texcoord.y;
+        mesh.colors[vertex * 4] = mesh.colors[vertex * 4 + 1] = mesh.colors[vertex * 4 + 2] = brightness;
+        mesh.colors[vertex * 4 + 3] = 255;
+        return vertex++;
+    };
+
+    result.minHeight = result.maxHeight = heightAt(0, 0);
+    for (int i = 0; i < side; i++)
+    {
+        for (int j = 0; j < side; j++)
+        {
+            addVertex(i, j, heightAt(i, j));
+            result.minHeight = std::min(result.minHeight, heightAt(i, j));
+            result.maxHeight = std::max(result.maxHeight, heightAt(i, j));
+        }
+    }
+
+    int index = 0;
+    const auto addTriangle = [&](const int a, const int b, const int c)
+    {
+        mesh.indices[index++] = static_cast<unsigned short>(a);
+        mesh.indices[index++] = static_cast<unsigned short>(b);
+        mesh.indices[index++] = static_cast<unsigned short>(c);
+    };
+
+    // Counter-clockwise seen from above
+    for (int i = 0; i < cells; i++)
+    {
+        for (int j = 0; j < cells; j++)
+        {
+            const int corner = i * side + j;
+            addTriangle(corner, corner + 1, corner + side);
+            addTriangle(corner + side, corner + 1, corner + side + 1);
+        }
+    }
+
+    // Along a shared edge, a neighbor at another rate interpolates the surface between its own samples. Both lines only bend at
+    // samples of the finest rate, so the widest gap to any neighbor shows at those, and skirts reach that far down.
+    const int fineSpacing = tileBlocks / tileCells[0];
+    const auto edgeHeightAt = [&](const int x, const int z, const int rateSpacing)
+    {
+        // Linear between the rate's samples around the block, along whichever axis the edge runs
+        const int along = x % tileBlocks == 0 ? z : x;
+        const int before = along / rateSpacing * rateSpacing, after = before + rateSpacing;
+        const float t = static_cast<float>(along - before) / static_cast<float>(rateSpacing);
+        const int beforeHeight = x % tileBlocks == 0 ? surface(originX + x, originZ + before) : surface(originX + before, originZ + z);
+        const int afterHeight = x % tileBlocks == 0 ? surface(originX + x, originZ + after) : surface(originX + after, originZ + z);
+        return static_cast<float>(beforeHeight) * (1 - t) + static_cast<float>(afterHeight) * t;
+    };
+
+    float widestGap = 0;
+    for (int k = 0; k <= tileBlocks; k += fineSpacing)
+    {
+        for (const auto& [x, z] : {std::pair{0, k}, std::pair{tileBlocks, k}, std::pair{k, 0}, std::pair{k, tileBlocks}})
+        {
+            const float own = edgeHeightAt(x, z, spacing);
+            for (const int rateCells : tileCells)
+                widestGap = std::max(widestGap, std::abs(edgeHeightAt(x, z, tileBlocks / rateCells) - own));
+        }
+    }
+    result.skirtDepth = static_cast<int>(std::ceil(widestGap)) + 1;
+
+    // Skirts hang down from all four edges, wound both ways as they can be seen from either side
+    const std::array<std::array<int, 4>, 4> edges = {{{0, 0, 0, 1}, {cells, 0, 0, 1}, {0, 0, 1, 0}, {0, cells, 1, 0}}}; // Start i, j and step
+    for (const auto& [startI, startJ, stepI, stepJ] : edges)
+    {
+        const int firstSkirt = vertex;
+        for (int k = 0; k < side; k++)
+        {
+            const int i = startI + k * stepI, j = startJ + k * stepJ;
+            addVertex(i, j, heightAt(i, j) - result.skirtDepth);
+        }
+
+        for (int k = 0; k < cells; k++)
+        {
+            const int top = (startI + k * stepI) * side + startJ + k * stepJ;
+            const int nextTop = (startI + (k + 1) * stepI) * side + startJ + (k + 1) * stepJ;
+            const int bottom = firstSkirt + k, nextBottom = firstSkirt + k + 1;
+            addTriangle(top, bottom, nextTop);
+            addTriangle(nextTop, bottom, nextBottom);
+            addTriangle(top, nextTop, bottom);
+            addTriangle(nextTop, nextBottom, bottom);
+        }
+    }
+
+    return result;
+}
+
+uint64_t FarTerrain::GetKey(const int tileX, const int tileZ)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(tileX)) << 32 | static_cast<uint32_t>(tileZ);
+}
+
+void FarTerrain::FreeVertexArrays(Mesh& mesh)
+{
+    // raylib only draws a mesh indexed while it still has its index array, that one stays until UnloadMesh
+    MemFree(mesh.vertices);
+    MemFree(mesh.texcoords);
+    MemFree(mesh.colors);
+    mesh.vertices = mesh.texcoords = nullptr;
+    mesh.colors = nullptr;
+}
+
+void FarTerrain::RunWorker()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping)
+            return;
+
+        building = requests.front();
+        requests.erase(requests.begin());
+        const Request request = *building;
+
+        lock.unlock();
+        TileBuild build = BuildTile(surface, request.tileX, request.tileZ, request.cells, surfaceTexcoord);
+        lock.lock();
+
+        finished.push_back(std::move(build));
+        building.reset();
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "hopscotch_map.h"
+#include "raylib.h"
+
+// Coarse heightmap terrain far beyond the loaded chunks, built straight from the surface noise.
+// Square tiles are meshed on a worker thread at fewer samples the further out they are, kept in a cache on the GPU,
+// and drawn everywhere outside the box of real chunks.
+class FarTerrain
+{
+    public:
+        // World y of the top of the surface at a block column; called from the worker thread
+        using SurfaceSampler = std::function<int(int x, int z)>;
+
+        static constexpr int tileBlocks = 256;
+        static constexpr int tileRadius = 4;                      // Tiles drawn around the camera's on every side
+        static constexpr std::array<int, 3> tileCells = {32, 16, 8}; // Samples per tile side at tile distance 0-1, 2-3 and beyond
+
+        // One tile as built on the worker, positions relative to the tile's corner
+        struct TileBuild
+        {
+            int tileX = 0, tileZ = 0, cells = 0;
+            Mesh mesh {};
+            int minHeight = 0, maxHeight = 0; // Of the surface, skirts reach further down
+            int skirtDepth = 0;
+        };
+
+        explicit FarTerrain(SurfaceSampler surface);
+        ~FarTerrain();
+
+        // Render thread
+        void Load(Shader shader, Texture2D texture, Vector2 surfaceTexcoord);
+        void Draw(Vector3 cameraPos, BoundingBox realChunks);
+
+        [[nodiscard]] static int GetCellsAt(int tileDistance);
+        [[nodiscard]] static TileBuild BuildTile(const SurfaceSampler& surface, int tileX, int tileZ, int cells, Vector2 texcoord);
+
+    private:
+        struct Tile
+        {
+            int cells = 0;
+            Mesh mesh {}; // GPU side and the index array
+            int minHeight = 0, maxHeight = 0, skirtDepth = 0;
+            unsigned long lastUsed = 0; // Frame it was last drawn in
+        };
+
+        struct Request
+        {
+            int tileX, tileZ, cells;
+        };
+
+        SurfaceSampler surface;
+        Material material {};
+        Vector2 surfaceTexcoord {};
+        int realMinLocation = -1, realMaxLocation = -1, cameraLocation = -1;
+
+        // Render thread only
+        tsl::hopscotch_map<uint64_t, Tile> tiles;
+        unsigned long frame = 0;
+        const size_t maxCachedTiles = 2 * (2 * tileRadius + 1) * (2 * tileRadius + 1);
+        const int uploadsPerFrame = 4;
+
+        // Shared with the worker, which always builds the nearest wanted tile first
+        std::vector<Request> requests;
+        std::vector<TileBuild> finished;
+        std::optional<Request> building;
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::thread worker;
+
+        static uint64_t GetKey(int tileX, int tileZ);
+        static void FreeVertexArrays(Mesh& mesh);
+        void RunWorker();
+};
@@ -0,0 +1,146 @@
+#include "farterrainverifier.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "farterrain.hpp"
+#include "PerlinNoise.hpp"
+
+namespace FarTerrainVerifier
+{
+    constexpr int tiles = 6; // Tiles along x and z, every neighboring pair is checked
+
+    struct Surface
+    {
+        std::string name;
+        FarTerrain::SurfaceSampler sample;
+    };
+
+    [[nodiscard]] static std::vector<Surface> GetSurfaces()
+    {
+        static const siv::PerlinNoise perlin{12345};
+        return {
+            {"Flat", [](int, int) { return 201; }},
+            {"World Surface", [](const int x, const int z) { return static_cast<int>(perlin.octave2D_01(x * 0.0075, z * 0.0075, 4) * 64) + 201; }},
+            {"Steep Noise", [](const int x, const int z) { return static_cast<int>(perlin.octave2D_01(x * 0.02, z * 0.02, 4) * 128) + 150; }},
+            {"Terraces", [](const int x, const int z) { return 200 + 6 * static_cast<int>(std::floor((perlin.octave2D_01(x * 0.01, z * 0.01, 2) * 64) / 6)); }},
+        };
+    }
+
+    // Heights of a tile's surface and of its skirt's lower edge along one tile edge, block by block, as the triangles interpolate them
+    struct EdgeProfile
+    {
+        std::vector<float> surface, skirtBottom;
+    };
+
+    [[nodiscard]] static EdgeProfile GetEdgeProfile(const FarTerrain::TileBuild& build, const bool alongX, const bool farSide)
+    {
+        const int side = build.cells + 1;
+        const int spacing = FarTerrain::tileBlocks / build.cells;
+        const int edge = (alongX ? 2 : 0) + (farSide ? 1 : 0); // In the order BuildTile adds skirts
+        const auto heightAt = [&](const int vertex) { return build.mesh.vertices[vertex * 3 + 1]; };
+        const auto surfaceVertex = [&](const int step)
+        {
+            const int i = alongX ? step : (farSide ? build.cells : 0);
+            const int j = alongX ? (farSide ? build.cells : 0) : step;
+            return i * side + j;
+        };
+
+        EdgeProfile result;
+        for (int block = 0; block <= FarTerrain::tileBlocks; block++)
+        {
+            const int k = std::min(block / spacing, build.cells - 1);
+            const float t = static_cast<float>(block - k * spacing) / static_cast<float>(spacing);
+            result.surface.push_back(heightAt(surfaceVertex(k)) * (1 - t) + heightAt(surfaceVertex(k + 1)) * t);
+            const int skirt = side * side + edge * side + k;
+            result.skirtBottom.push_back(heightAt(skirt) * (1 - t) + heightAt(skirt + 1) * t);
+        }
+
+        return result;
+    }
+
+    static void FreeBuild(FarTerrain::TileBuild& build)
+    {
+        MemFree(build.mesh.vertices);
+        MemFree(build.mesh.texcoords);
+        MemFree(build.mesh.colors);
+        MemFree(build.mesh.indices);
+    }
+
+    int Run()
+    {
+        int failures = 0;
+        for (const auto& [name, sample] : GetSurfaces())
+        {
+            int misplaced = 0, cracks = 0, edges = 0;
+            float widestGap = 0;
+            for (size_t a = 0; a < FarTerrain::tileCells.size(); a++)
+            {
+                for (size_t b = 0; b < FarTerrain::tileCells.size(); b++)
+                {
+                    // Tiles alternate between two rates in a checkerboard, so every edge joins both
+                    std::vector<FarTerrain::TileBuild> builds;
+                    for (int x = 0; x < tiles; x++)
+                        for (int z = 0; z < tiles; z++)
+                            builds.push_back(FarTerrain::BuildTile(sample, x, z, FarTerrain::tileCells[(x + z) % 2 == 0 ? a : b], Vector2{}));
+
+                    for (const auto& build : builds)
+                    {
+                        const int side = build.cells + 1;
+                        const int spacing = FarTerrain::tileBlocks / build.cells;
+                        for (int i = 0; i < side; i++)
+                        {
+                            for (int j = 0; j < side; j++)
+                            {
+                                const float height = build.mesh.vertices[(i * side + j) * 3 + 1];
+                                misplaced += height != static_cast<float>(sample(build.tileX * FarTerrain::tileBlocks + i * spacing, build.tileZ * FarTerrain::tileBlocks + j * spacing));
+                            }
+                        }
+                    }
+
+                    for (int x = 0; x < tiles; x++)
+                    {
+                        for (int z = 0; z < tiles; z++)
+                        {
+                            const auto& build = builds[x * tiles + z];
+                            for (const bool alongX : {false, true})
+                            {
+                                if ((alongX ? z : x) + 1 >= tiles)
+                                    continue;
+
+                                // The far edge of this tile is the near edge of its neighbor
+                                const auto& neighbor = builds[alongX ? x * tiles + z + 1 : (x + 1) * tiles + z];
+                                const EdgeProfile own = GetEdgeProfile(build, alongX, true);
+                                const EdgeProfile other = GetEdgeProfile(neighbor, alongX, false);
+                                edges++;
+                                for (size_t block = 0; block < own.surface.size(); block++)
+                                {
+                                    // The higher side's skirt has to reach the lower side's surface
+                                    const bool higher = own.surface[block] > other.surface[block];
+                                    const float lowerSurface = higher ? other.surface[block] : own.surface[block];
+                                    widestGap = std::max(widestGap, std::abs(own.surface[block] - other.surface[block]));
+                                    cracks += (higher ? own.skirtBottom[block] : other.skirtBottom[block]) > lowerSurface;
+                                }
+                            }
+                        }
+                    }
+
+                    for (auto& build : builds)
+                        FreeBuild(build);
+                }
+            }
+
+            if (misplaced == 0 && cracks == 0)
+            {
+                std::cout << "PASS " << name << " (" << edges << " tile edges, widest gap " << widestGap << " blocks)" << std::endl;
+                continue;
+            }
+
+            failures++;
+            std::cout << "FAIL " << name << ": " << misplaced << " vertices off the surface, " << cracks << " blocks of tile edges with uncovered cracks" << std::endl;
+        }
+
+        return failures == 0 ? 0 : 1;
+    }
+}
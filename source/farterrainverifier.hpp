@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless check of far terrain tiles: every surface vertex sits on the sampled surface, and wherever two neighboring tiles
+// sampled at different rates disagree along their shared edge, the higher one's skirt reaches down past the lower one
+namespace FarTerrainVerifier
+{
+    // Builds tiles of a few surfaces at every sample rate and prints the results; returns a process exit code
+    int Run();
+}
@@ -0,0 +1,126 @@
+#include "framegovernor.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+FrameGovernor::FrameGovernor(const Settings& settings, const int renderDistance, const size_t uploadBytesPerFrame, const int workers) :
+    settings(settings), ceilingRetryWindows(settings.retryWindows)
+{
+    metrics.renderDistance = std::clamp(renderDistance, settings.minRenderDistance, settings.maxRenderDistance);
+    metrics.uploadBytesPerFrame = std::clamp(uploadBytesPerFrame, settings.minUploadBytes, settings.maxUploadBytes);
+    metrics.workers = std::clamp(workers, settings.minWorkers, settings.maxWorkers);
+}
+
+bool FrameGovernor::AddFrame(const Sample& sample)
+{
+    window.push_back(sample);
+    windowElapsed += sample.frameMilliseconds;
+    if (windowElapsed < settings.windowMilliseconds)
+        return false;
+
+    const bool changed = Evaluate();
+    window.clear();
+    windowElapsed = 0;
+
+    return changed;
+}
+
+const FrameGovernor::Metrics& FrameGovernor::GetMetrics() const
+{
+    return metrics;
+}
+
+const FrameGovernor::Settings& FrameGovernor::GetSettings() const
+{
+    return settings;
+}
+
+void FrameGovernor::SetLogDecisions(const bool enabled)
+{
+    settings.logDecisions = enabled;
+}
+
+bool FrameGovernor::Evaluate()
+{
+    // Hitches matter more than the average, so frames are judged by their 90th percentile
+    std::vector<double> frames;
+    double work = 0, tick = 0;
+    for (const Sample& sample : window)
+    {
+        frames.push_back(sample.frameMilliseconds);
+        work += sample.workMilliseconds;
+        tick += sample.tickMilliseconds;
+    }
+    std::ranges::sort(frames);
+    metrics.frameMilliseconds = frames[std::min(frames.size() * 9 / 10, frames.size() - 1)];
+    metrics.workMilliseconds = work / static_cast<double>(window.size());
+    metrics.tickMilliseconds = tick / static_cast<double>(window.size());
+    metrics.pendingUploads = window.back().pendingUploads;
+    metrics.windows++;
+
+    // Vsync pads frames up to the target, so only the work inside them tells how much room is left
+    const double target = settings.targetFrameMilliseconds;
+    const bool overBudget = metrics.frameMilliseconds > target * 1.1;
+    const bool headroom = !overBudget && metrics.workMilliseconds < target * 0.6;
+    const bool simulationBehind = metrics.tickMilliseconds > settings.tickMilliseconds;
+    const bool backlog = metrics.pendingUploads > 0;
+    const unsigned long decisionsBefore = metrics.decisions;
+
+    // Uploads back off quickly and creep back up while there is something to upload
+    const size_t uploadBytes = metrics.uploadBytesPerFrame;
+    if (overBudget)
+        metrics.uploadBytesPerFrame = std::max(uploadBytes / 2, settings.minUploadBytes);
+    else if (headroom && backlog)
+        metrics.uploadBytesPerFrame = std::min(uploadBytes + settings.uploadStepBytes, settings.maxUploadBytes);
+    if (metrics.uploadBytesPerFrame != uploadBytes)
+        Decide("upload KB per frame", static_cast<double>(uploadBytes) / 1024, static_cast<double>(metrics.uploadBytesPerFrame) / 1024);
+
+    // Chunk workers only matter while the simulation is streaming, and then compete with the frame for cores
+    const int workers = metrics.workers;
+    if (simulationBehind && overBudget)
+        metrics.workers = std::max(workers - 1, settings.minWorkers);
+    else if (simulationBehind && headroom)
+        metrics.workers = std::min(workers + 1, settings.maxWorkers);
+    if (metrics.workers != workers)
+        Decide("chunk workers", workers, metrics.workers);
+
+    // The render distance is the most expensive knob to turn, it only follows verdicts that held for a while.
+    // It shrinks once uploads can't be cut any further, and grows only when nothing is left waiting.
+    // A distance that had to be given up isn't tried again for a while, so a scene right at the edge doesn't flip back and forth.
+    overWindows = overBudget ? overWindows + 1 : 0;
+    headroomWindows = headroom && !backlog && !simulationBehind ? headroomWindows + 1 : 0;
+    ceilingWindows = std::max(ceilingWindows - 1, 0);
+    const int renderDistance = metrics.renderDistance;
+    if (overWindows >= settings.distanceHoldWindows && metrics.uploadBytesPerFrame == settings.minUploadBytes)
+    {
+        metrics.renderDistance = std::max(renderDistance - 1, settings.minRenderDistance);
+        ceilingRetryWindows = renderDistance == ceiling ? ceilingRetryWindows * 2 : settings.retryWindows;
+        ceiling = renderDistance;
+        ceilingWindows = ceilingRetryWindows;
+    }
+    else if (headroomWindows >= settings.distanceHoldWindows && (renderDistance + 1 < ceiling || ceilingWindows == 0))
+    {
+        metrics.renderDistance = std::min(renderDistance + 1, settings.maxRenderDistance);
+    }
+    if (metrics.renderDistance != renderDistance)
+    {
+        Decide("render distance", renderDistance, metrics.renderDistance);
+        overWindows = headroomWindows = 0;
+    }
+
+    return metrics.decisions != decisionsBefore;
+}
+
+void FrameGovernor::Decide(const std::string& what, const double before, const double after)
+{
+    std::ostringstream decision;
+    decision << std::fixed << std::setprecision(1) << what << " " << before << " -> " << after << " (frame " << metrics.frameMilliseconds
+             << " ms, work " << metrics.workMilliseconds << " ms, tick " << metrics.tickMilliseconds << " ms, " << metrics.pendingUploads << " uploads pending)";
+
+    metrics.decisions++;
+    metrics.lastDecision = decision.str();
+    if (settings.logDecisions)
+        std::cout << "Frame governor: " << metrics.lastDecision << std::endl;
+}
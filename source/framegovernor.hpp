@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Holds a target frame time by trading render distance, mesh upload budget and chunk worker threads against it.
+// Fed once per frame on the main thread and judged in short windows; every change it makes is kept in its metrics,
+// and printed too while logging is on.
+class FrameGovernor
+{
+    public:
+        struct Settings
+        {
+            double targetFrameMilliseconds = 1000.0 / 60.0;
+            double tickMilliseconds = 1000.0 / 30.0; // Simulation ticks taking longer than this are falling behind
+            int minRenderDistance = 2, maxRenderDistance = 16;
+            size_t minUploadBytes = 256 * 1024, maxUploadBytes = 16 * 1024 * 1024;
+            size_t uploadStepBytes = 512 * 1024;
+            int minWorkers = 1, maxWorkers = 8;
+            double windowMilliseconds = 500.0; // Frames are judged together over windows this long
+            int distanceHoldWindows = 4;       // Windows a verdict has to hold before the render distance follows it
+            int retryWindows = 120;            // Windows before a render distance that didn't hold is tried again, doubled every time it fails
+            bool logDecisions = false;
+        };
+
+        // One frame as measured by the main thread
+        struct Sample
+        {
+            double frameMilliseconds = 0; // Whole frame, including waiting for vsync
+            double workMilliseconds = 0;  // Update and draw calls only, what the frame could shrink to
+            int pendingUploads = 0;       // Chunk meshes still waiting for their upload after the frame
+            double tickMilliseconds = 0;  // Duration of the latest simulation tick
+        };
+
+        struct Metrics
+        {
+            // Latest window
+            double frameMilliseconds = 0; // 90th percentile
+            double workMilliseconds = 0;  // Mean
+            double tickMilliseconds = 0;  // Mean
+            int pendingUploads = 0;       // Last frame
+
+            // Current decisions
+            int renderDistance = 0;
+            size_t uploadBytesPerFrame = 0;
+            int workers = 0;
+
+            unsigned long windows = 0;
+            unsigned long decisions = 0; // Changes made so far
+            std::string lastDecision;
+        };
+
+        FrameGovernor(const Settings& settings, int renderDistance, size_t uploadBytesPerFrame, int workers);
+
+        // Returns true when the frame closed a window that changed a decision
+        bool AddFrame(const Sample& sample);
+
+        [[nodiscard]] const Metrics& GetMetrics() const;
+        [[nodiscard]] const Settings& GetSettings() const;
+        void SetLogDecisions(bool enabled);
+
+    private:
+        Settings settings;
+        Metrics metrics;
+
+        std::vector<Sample> window;
+        double windowElapsed = 0;
+        int overWindows = 0, headroomWindows = 0;
+
+        // Lowest render distance that had to be given up, and how long until it may be tried again
+        int ceiling = 0;
+        int ceilingWindows = 0, ceilingRetryWindows;
+
+        bool Evaluate();
+        void Decide(const std::string& what, double before, double after);
+};
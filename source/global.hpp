@@ -1,4 +1,18 @@
 #pragma once
 
+#include <cstdint>
+
+#include "raylib.h"
+
 static constexpr unsigned int CHUNK_WIDTH = 32;
-static constexpr unsigned int CHUNK_HEIGHT = 32;
\ No newline at end of file
+static constexpr unsigned int CHUNK_HEIGHT = 32;
+
+// Hash map key of a position on a grid of chunks or regions, its three coordinates packed into 21 bits each
+inline uint64_t GetGridKey(const Vector3 gridPos)
+{
+    const auto x = static_cast<uint64_t>(static_cast<int64_t>(gridPos.x)) & 0x1FFFFF;
+    const auto y = static_cast<uint64_t>(static_cast<int64_t>(gridPos.y)) & 0x1FFFFF;
+    const auto z = static_cast<uint64_t>(static_cast<int64_t>(gridPos.z)) & 0x1FFFFF;
+
+    return (x << 42) | (y << 21) | z;
+}
@@ -0,0 +1,134 @@
+#include "governorverifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "framegovernor.hpp"
+
+namespace GovernorVerifier
+{
+    // Frame costs of a made-up machine, in milliseconds
+    struct Machine
+    {
+        std::string name;
+        double baseCost;       // Every frame, whatever is drawn
+        double chunkCost;      // Per chunk column in the render distance, drawing grows with the visible area
+        double uploadCost;     // Per MB of meshes uploaded in the frame
+        double generateCost;   // Per chunk streamed in, spread over the chunk workers
+        double workerCost;     // Per chunk worker busy while streaming, they take cores from the render thread
+        enum class Expect { Fits, Maximum, Minimum } expect;
+    };
+
+    constexpr double simulatedSeconds = 240.0;
+    constexpr double settleSeconds = 60.0; // Judged over the end of the run, once the governor had time to settle
+    constexpr double meshBytesPerChunk = 48 * 1024;
+
+    [[nodiscard]] static std::vector<Machine> GetMachines()
+    {
+        return {
+            {"High End", 2.0, 0.005, 0.5, 1.0, 0.05, Machine::Expect::Maximum},
+            {"Mid Range", 4.0, 0.06, 1.5, 3.0, 0.2, Machine::Expect::Fits},
+            {"Low End", 7.0, 0.12, 3.0, 6.0, 0.4, Machine::Expect::Fits},
+            {"Slow Uploads", 3.0, 0.04, 12.0, 2.0, 0.1, Machine::Expect::Fits},
+            {"Steep Scene", 2.5, 0.45, 2.0, 3.0, 0.2, Machine::Expect::Fits},
+            {"Overloaded", 22.0, 0.1, 2.0, 5.0, 0.5, Machine::Expect::Minimum},
+        };
+    }
+
+    // Only a few layers of chunks around the player's are loaded, so streaming grows with the area like drawing does
+    [[nodiscard]] static int GetLoadedChunks(const int renderDistance)
+    {
+        const int size = renderDistance * 2;
+        return size * size * 4;
+    }
+
+    int Run()
+    {
+        FrameGovernor::Settings settings;
+        settings.logDecisions = false;
+        settings.maxWorkers = 8;
+        const double target = settings.targetFrameMilliseconds;
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution jitter(0.9, 1.1);
+        int failures = 0;
+        for (const auto& machine : GetMachines())
+        {
+            FrameGovernor governor(settings, 4, 4 * 1024 * 1024, settings.maxWorkers);
+
+            // Streaming starts out with the whole initial range, later with whatever a larger distance adds
+            double backlogBytes = GetLoadedChunks(4) * meshBytesPerChunk;
+            double streamingLeft = 0, tickMilliseconds = 0;
+            int loadedDistance = 4;
+
+            double elapsed = 0, workMilliseconds = 0;
+            std::vector<double> settledFrames;
+            int settledDistanceChanges = 0;
+            while (elapsed < simulatedSeconds * 1000)
+            {
+                const FrameGovernor::Metrics& metrics = governor.GetMetrics();
+
+                // The simulation picks up a new distance and streams in its chunks on the workers, the renderer uploads them after
+                if (metrics.renderDistance != loadedDistance)
+                {
+                    const int added = std::max(GetLoadedChunks(metrics.renderDistance) - GetLoadedChunks(loadedDistance), 0);
+                    backlogBytes += added * meshBytesPerChunk;
+                    streamingLeft += added * machine.generateCost / metrics.workers;
+                    if (elapsed >= (simulatedSeconds - settleSeconds) * 1000)
+                        settledDistanceChanges++;
+                    loadedDistance = metrics.renderDistance;
+                }
+
+                const double uploadBytes = std::min(backlogBytes, static_cast<double>(metrics.uploadBytesPerFrame));
+                backlogBytes -= uploadBytes;
+                const bool streaming = streamingLeft > 0;
+                tickMilliseconds = streaming ? std::max(streamingLeft, 1000.0 / 30.0 * 1.5) : 2.0;
+
+                const int columns = loadedDistance * 2 * loadedDistance * 2;
+                workMilliseconds = (machine.baseCost + machine.chunkCost * columns + machine.uploadCost * uploadBytes / (1024 * 1024) +
+                                    (streaming ? machine.workerCost * metrics.workers : 0)) * jitter(random);
+
+                // Vsync rounds every frame up to a whole number of refresh intervals
+                const double frameMilliseconds = std::ceil(workMilliseconds / target - 0.01) * target;
+                streamingLeft = std::max(streamingLeft - frameMilliseconds, 0.0);
+                elapsed += frameMilliseconds;
+                if (elapsed >= (simulatedSeconds - settleSeconds) * 1000)
+                    settledFrames.push_back(frameMilliseconds);
+
+                const int pendingUploads = static_cast<int>(std::ceil(backlogBytes / meshBytesPerChunk));
+                governor.AddFrame({frameMilliseconds, workMilliseconds, pendingUploads, tickMilliseconds});
+            }
+
+            const FrameGovernor::Metrics& metrics = governor.GetMetrics();
+            std::ranges::sort(settledFrames);
+            const double settledFrame = settledFrames[settledFrames.size() * 9 / 10];
+
+            std::string problem;
+            if (settledDistanceChanges > 2)
+                problem = "render distance still changing (" + std::to_string(settledDistanceChanges) + " times at the end)";
+            else if (machine.expect != Machine::Expect::Minimum && settledFrame > target * 1.1)
+                problem = "frames over target (" + std::to_string(settledFrame) + " ms)";
+            else if (machine.expect == Machine::Expect::Maximum && metrics.renderDistance != settings.maxRenderDistance)
+                problem = "render distance " + std::to_string(metrics.renderDistance) + " below the maximum";
+            else if (machine.expect == Machine::Expect::Minimum &&
+                     (metrics.renderDistance != settings.minRenderDistance || metrics.uploadBytesPerFrame != settings.minUploadBytes))
+                problem = "not at the minimum settings";
+
+            if (problem.empty())
+            {
+                std::cout << "PASS " << machine.name << " (render distance " << metrics.renderDistance << ", " << metrics.uploadBytesPerFrame / 1024
+                          << " KB uploads per frame, " << metrics.workers << " workers, " << metrics.decisions << " decisions, frames "
+                          << settledFrame << " ms)" << std::endl;
+                continue;
+            }
+
+            failures++;
+            std::cout << "FAIL " << machine.name << ": " << problem << std::endl;
+        }
+
+        return failures == 0 ? 0 : 1;
+    }
+}
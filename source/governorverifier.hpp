@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless check of the frame governor against simulated machines: fast ones must be raised to the most they allow,
+// slow ones brought down until frames fit the target, and neither may keep flipping the render distance back and forth
+namespace GovernorVerifier
+{
+    // Runs every simulated machine for a few minutes of frames and prints the results; returns a process exit code
+    int Run();
+}
@@ -0,0 +1,95 @@
+#include "headlessrun.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+#include "backend.hpp"
+#include "core.hpp"
+
+namespace HeadlessRun
+{
+    static constexpr int targetFps = 60;
+    static constexpr float flySpeed = 16.0f;   // Blocks per second along +x, streams in a new chunk slice every two seconds
+    static constexpr float lookSweep = 0.8f;    // Radians the view swings to either side, so culling sees chunks come and go
+    static constexpr int reportEveryFrames = 120;
+
+    int Run(const int frames)
+    {
+        SetTraceLogLevel(LOG_ERROR);
+        Backend::UseNull();
+        Backend::SetTargetFPS(targetFps);
+
+        std::cout << "Headless run, " << frames << " frames at " << targetFps << " fps" << std::endl;
+
+        // Every run starts from a fresh world instead of the last run's saves
+        const std::filesystem::path saveDirectory = std::filesystem::temp_directory_path() / "minecraylib-headless";
+        std::filesystem::remove_all(saveDirectory);
+
+        const auto start = std::chrono::steady_clock::now();
+        unsigned long long peakUploaded = 0;
+        for (const char* pass : {"New world", "Saved world"})
+        {
+            std::cout << std::endl << pass << std::endl;
+            std::cout << std::left << std::setw(8) << "Frame" << std::right << std::setw(10) << "draws" << std::setw(14) << "Mvertices"
+                      << std::setw(14) << "KB uploaded" << std::setw(10) << "pending" << std::setw(10) << "distance" << std::setw(12) << "p90 ms"
+                      << std::setw(12) << "work ms" << std::setw(12) << "tick ms" << std::setw(10) << "loads q" << std::setw(10) << "saves q" << std::endl;
+
+            Core core(saveDirectory);
+            Backend::Stats reported = Backend::GetStats();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                const float seconds = static_cast<float>(frame) / targetFps;
+                const float yaw = lookSweep * std::sin(seconds * 0.5f);
+                const Vector3 position = {16 + flySpeed * seconds, 240, 16};
+                core.SetCamera(position, Vector3{position.x + std::cos(yaw), position.y - 0.3f, position.z + std::sin(yaw)});
+
+                const Backend::Stats before = Backend::GetStats();
+                core.Update(Backend::GetFrameTime());
+                core.Render();
+                const Backend::Stats& after = Backend::GetStats();
+                peakUploaded = std::max(peakUploaded, after.uploadedBytes - before.uploadedBytes);
+
+                if ((frame + 1) % reportEveryFrames != 0 && frame + 1 != frames)
+                    continue;
+
+                // Means over the frames since the last report, queue depths as of now
+                const auto count = static_cast<double>(after.frames - reported.frames);
+                const FrameGovernor::Metrics& metrics = core.GetGovernor().GetMetrics();
+                const ChunkIo::Stats io = core.GetWorld().GetIoStats();
+                std::cout << std::left << std::setw(8) << frame + 1 << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(10) << (after.drawCalls - reported.drawCalls) / count
+                          << std::setw(14) << (after.vertices - reported.vertices) / count / 1e6
+                          << std::setw(14) << (after.uploadedBytes - reported.uploadedBytes) / count / 1024
+                          << std::setw(10) << core.GetWorld().GetPendingUploads() << std::setw(10) << metrics.renderDistance
+                          << std::setw(12) << metrics.frameMilliseconds << std::setw(12) << metrics.workMilliseconds
+                          << std::setw(12) << metrics.tickMilliseconds << std::setw(10) << io.queuedLoads + io.finishedLoads
+                          << std::setw(10) << io.queuedSaves << std::endl;
+                reported = after;
+            }
+
+            const ChunkIo::Stats io = core.GetWorld().GetIoStats();
+            std::cout << "Chunk meshes: " << core.GetWorld().GetArenaBytes() / 1024 << " KB in the vertex arena, "
+                      << World::GetCpuMeshBytes() / 1024 << " KB on the CPU" << std::endl;
+            std::cout << "Chunk I/O: " << io.loads << " loaded, " << io.saves << " saved (" << io.coalescedSaves << " coalesced) in "
+                      << io.flushes << " flushes" << std::endl;
+            const ChunkCache::Stats cache = core.GetWorld().GetCacheStats();
+            std::cout << "Chunk cache: " << cache.hits << " hits (" << cache.meshHits << " with mesh), " << cache.misses << " misses, "
+                      << cache.staleMeshes << " meshes dropped for changed neighbors, " << cache.evictions << " evictions, "
+                      << cache.bytes / 1024 << " KB" << std::endl;
+        }
+
+        const Backend::Stats& stats = Backend::GetStats();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::filesystem::remove_all(saveDirectory);
+        std::cout << std::endl << "Total: " << stats.drawCalls << " draw calls, " << stats.vertices / 1000000 << " M vertices, "
+                  << stats.uploadedBytes / 1024 << " KB uploaded (at most " << peakUploaded / 1024 << " KB in one frame) in "
+                  << std::setprecision(1) << seconds << " s" << std::endl;
+
+        // Something has to have made it to the screen
+        return stats.drawCalls > 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// The full frame loop of Core (simulation, streaming, culling, upload scheduling and drawing) on the null backend,
+// so it can be driven and measured without a window, GPU or audio device
+namespace HeadlessRun
+{
+    // Flies the camera along a fixed path for the given number of frames at 60 fps and prints what each frame cost.
+    // Flies it a second time through the world the first flight saved. Returns a process exit code.
+    int Run(int frames = 600);
+}
@@ -0,0 +1,141 @@
+#include "horizonculler.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+HorizonCuller::Slab HorizonCuller::ComputeSlab(const std::vector<const Chunk*>& columnTopDown)
+{
+    // The slab is where the topmost solid runs of all block columns overlap
+    Slab result {INT_MIN, INT_MAX};
+    for (int i = 0; i < CHUNK_WIDTH * CHUNK_WIDTH; i++)
+    {
+        bool found = false;
+        int runTop = 0, runBottom = 0;
+        for (const Chunk* chunk : columnTopDown)
+        {
+            if (chunk == nullptr)
+            {
+                if (found)
+                    break;
+                continue;
+            }
+
+            const auto [top, run] = chunk->columnSummaries[i];
+            const int chunkY = static_cast<int>(chunk->worldPosition.y);
+            if (!found)
+            {
+                if (top < 0)
+                    continue;
+
+                found = true;
+                runTop = chunkY + top;
+                runBottom = runTop - run + 1;
+                if (top - run + 1 > 0)
+                    break;
+            }
+            else
+            {
+                // The run carries on into this chunk only through its topmost block
+                if (top != CHUNK_HEIGHT - 1)
+                    break;
+
+                runBottom -= run;
+                if (run < CHUNK_HEIGHT)
+                    break;
+            }
+        }
+
+        if (!found)
+            return {};
+
+        result.bottom = std::max(result.bottom, runBottom);
+        result.top = std::min(result.top, runTop);
+        if (result.IsEmpty())
+            return {};
+    }
+
+    return result;
+}
+
+void HorizonCuller::Reset(const int minX, const int minZ, const int sizeX, const int sizeZ)
+{
+    this->minX = minX;
+    this->minZ = minZ;
+    this->sizeX = sizeX;
+    this->sizeZ = sizeZ;
+    slabs.assign(sizeX * sizeZ, Slab{});
+    bands.assign(sizeX * sizeZ, Slab{});
+    cameraInside = false;
+}
+
+void HorizonCuller::SetSlab(const int x, const int z, const Slab slab)
+{
+    if (const int index = GetIndex(x, z); index >= 0)
+        slabs[index] = slab;
+}
+
+void HorizonCuller::SetCamera(const Vector3 cameraPos)
+{
+    const int cameraX = static_cast<int>(std::floor(cameraPos.x / static_cast<float>(CHUNK_WIDTH)));
+    const int cameraZ = static_cast<int>(std::floor(cameraPos.z / static_cast<float>(CHUNK_WIDTH)));
+    cameraY = cameraPos.y;
+    cameraInside = GetIndex(cameraX, cameraZ) >= 0;
+    if (!cameraInside)
+        return;
+
+    // Columns ordered outward from the camera's, so the one a step closer to the camera always comes first
+    const auto outward = [](const int center, const int min, const int size)
+    {
+        std::vector<int> result;
+        for (int i = center; i >= min; i--)
+            result.push_back(i);
+        for (int i = center + 1; i < min + size; i++)
+            result.push_back(i);
+        return result;
+    };
+
+    // A column's band is its own slab, narrowed by the bands of its neighbors a step closer to the camera.
+    // That works out to the overlap of every slab in the rectangle spanned by the camera's column and it.
+    for (const int x : outward(cameraX, minX, sizeX))
+    {
+        for (const int z : outward(cameraZ, minZ, sizeZ))
+        {
+            Slab band = slabs[GetIndex(x, z)];
+            if (x != cameraX)
+            {
+                const Slab& closer = bands[GetIndex(x < cameraX ? x + 1 : x - 1, z)];
+                band = {std::max(band.bottom, closer.bottom), std::min(band.top, closer.top)};
+            }
+            if (z != cameraZ)
+            {
+                const Slab& closer = bands[GetIndex(x, z < cameraZ ? z + 1 : z - 1)];
+                band = {std::max(band.bottom, closer.bottom), std::min(band.top, closer.top)};
+            }
+            bands[GetIndex(x, z)] = band;
+        }
+    }
+}
+
+bool HorizonCuller::IsHidden(const Vector3 chunkPos) const
+{
+    if (!cameraInside)
+        return false;
+
+    const int index = GetIndex(static_cast<int>(chunkPos.x), static_cast<int>(chunkPos.z));
+    if (index < 0 || bands[index].IsEmpty())
+        return false;
+
+    // A ray from a camera above the band down to the top of a chunk inside or below it spends a stretch at the band's heights,
+    // somewhere between the two columns, and every column there is solid at those heights
+    const Slab& band = bands[index];
+    const float chunkTop = chunkPos.y * CHUNK_HEIGHT + CHUNK_HEIGHT;
+    return cameraY >= static_cast<float>(band.top + 1) && chunkTop <= static_cast<float>(band.top);
+}
+
+int HorizonCuller::GetIndex(const int x, const int z) const
+{
+    if (x < minX || z < minZ || x >= minX + sizeX || z >= minZ + sizeZ)
+        return -1;
+    return (x - minX) * sizeZ + (z - minZ);
+}
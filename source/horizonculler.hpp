@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "chunk.hpp"
+
+// Conservative occlusion of chunks buried below the terrain, for cameras above it.
+// Every chunk column gets a slab: a range of heights that is solid over the column's whole footprint.
+// A ray from above a slab down to a chunk that ends below the slab's top has to pass through solid blocks,
+// as long as all columns the ray crosses share some solid heights.
+class HorizonCuller
+{
+    public:
+        // World y of the lowest and highest solid layer, empty when bottom > top
+        struct Slab
+        {
+            int bottom = 0, top = -1;
+
+            [[nodiscard]] bool IsEmpty() const { return bottom > top; }
+        };
+
+        // Slab of one chunk column from the column summaries of its chunks, ordered top to bottom.
+        // Missing chunks (nullptr) count as not solid.
+        [[nodiscard]] static Slab ComputeSlab(const std::vector<const Chunk*>& columnTopDown);
+
+        // Covers chunk columns minX..minX + sizeX - 1 and minZ..minZ + sizeZ - 1, all with empty slabs
+        void Reset(int minX, int minZ, int sizeX, int sizeZ);
+        void SetSlab(int x, int z, Slab slab);
+
+        // Shares slabs out over the columns between the camera and every other column; call before IsHidden
+        void SetCamera(Vector3 cameraPos);
+        [[nodiscard]] bool IsHidden(Vector3 chunkPos) const;
+
+    private:
+        int minX = 0, minZ = 0, sizeX = 0, sizeZ = 0;
+        std::vector<Slab> slabs;
+        std::vector<Slab> bands; // Per column, the heights solid in every column from the camera's to it
+        float cameraY = 0;
+        bool cameraInside = false;
+
+        [[nodiscard]] int GetIndex(int x, int z) const;
+};
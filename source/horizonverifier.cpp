@@ -0,0 +1,253 @@
+#include "horizonverifier.hpp"
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "blocktype.hpp"
+#include "horizonculler.hpp"
+#include "PerlinNoise.hpp"
+
+namespace HorizonVerifier
+{
+    constexpr int columns = 6;  // Chunk columns along x and z
+    constexpr int height = 6;   // Chunks stacked in every column
+
+    struct Heightfield
+    {
+        std::string name;
+        std::function<unsigned char(int x, int y, int z)> block;
+    };
+
+    class Grid
+    {
+        public:
+            explicit Grid(const std::function<unsigned char(int x, int y, int z)>& block)
+            {
+                for (int cx = 0; cx < columns; cx++)
+                {
+                    for (int cy = 0; cy < height; cy++)
+                    {
+                        for (int cz = 0; cz < columns; cz++)
+                        {
+                            auto chunk = std::make_unique<Chunk>(nullptr, Vector3{static_cast<float>(cx), static_cast<float>(cy), static_cast<float>(cz)});
+                            for (int x = 0; x < CHUNK_WIDTH; x++)
+                                for (int y = 0; y < CHUNK_HEIGHT; y++)
+                                    for (int z = 0; z < CHUNK_WIDTH; z++)
+                                        chunk->data[x][y][z] = block(cx * CHUNK_WIDTH + x, cy * CHUNK_HEIGHT + y, cz * CHUNK_WIDTH + z);
+                            chunk->ComputeColumnSummaries();
+                            chunks.push_back(std::move(chunk));
+                        }
+                    }
+                }
+            }
+
+            [[nodiscard]] const Chunk* GetChunk(const int cx, const int cy, const int cz) const
+            {
+                return chunks[(cx * height + cy) * columns + cz].get();
+            }
+
+            [[nodiscard]] bool IsSolid(const int x, const int y, const int z) const
+            {
+                if (x < 0 || y < 0 || z < 0 || x >= columns * CHUNK_WIDTH || y >= height * CHUNK_HEIGHT || z >= columns * CHUNK_WIDTH)
+                    return false;
+                const Chunk* chunk = GetChunk(x / CHUNK_WIDTH, y / CHUNK_HEIGHT, z / CHUNK_WIDTH);
+                return !BlockType::Types[chunk->data[x % CHUNK_WIDTH][y % CHUNK_HEIGHT][z % CHUNK_WIDTH]].isTransparent;
+            }
+
+        private:
+            std::vector<std::unique_ptr<Chunk>> chunks;
+    };
+
+    static const std::vector<Heightfield>& GetHeightfields()
+    {
+        static const siv::PerlinNoise perlin{1234};
+        const auto hills = [](const int x, const int z)
+        {
+            return 100 + static_cast<int>(30 * std::sin(x / 23.0) * std::cos(z / 31.0));
+        };
+
+        static const std::vector<Heightfield> heightfields = {
+            {"Flat", [](int, const int y, int) -> unsigned char { return y <= 100 ? 4 : 0; }},
+            {"Rolling Hills", [hills](const int x, const int y, const int z) -> unsigned char { return y <= hills(x, z) ? 4 : 0; }},
+            {"Rough Noise", [](const int x, const int y, const int z) -> unsigned char
+            {
+                return y <= 30 + static_cast<int>(perlin.octave2D_01(x * 0.05, z * 0.05, 4) * 130) ? 4 : 0;
+            }},
+            {"Cliff", [](const int x, const int y, int) -> unsigned char { return y <= (x < 90 ? 150 : 30) ? 4 : 0; }},
+            {"Hills With Caves", [hills](const int x, const int y, const int z) -> unsigned char
+            {
+                // Caves well under the surface, with a shaft breaking through to them
+                const int surface = hills(x, z);
+                if (y > surface)
+                    return 0;
+                if (x >= 40 && x < 43 && z >= 40 && z < 43 && y > 40)
+                    return 0;
+                return y < surface - 40 && perlin.octave3D(x * 0.04, y * 0.04, z * 0.04, 3) > 0.3 ? 0 : 4;
+            }},
+            {"Overhangs", [](const int x, const int y, const int z) -> unsigned char
+            {
+                // Thin floating shelves above the ground, with gaps under them
+                if (y <= 60)
+                    return 4;
+                return y >= 120 && y <= 122 && (x / 16 + z / 16) % 2 == 0 ? 4 : 0;
+            }},
+            {"Glass Roof", [](const int x, const int y, const int z) -> unsigned char
+            {
+                // Glass doesn't block sight, the stone under it does
+                if (y <= 60)
+                    return 4;
+                return y <= 100 && (x + z) % 7 != 0 ? 6 : 0;
+            }},
+        };
+
+        return heightfields;
+    }
+
+    // Whether the segment from origin to target passes through a solid block before reaching the box (min, max)
+    static bool IsBlocked(const Grid& grid, const Vector3 origin, const Vector3 target, const Vector3 min, const Vector3 max)
+    {
+        const std::array<float, 3> start = {origin.x, origin.y, origin.z};
+        const std::array<float, 3> delta = {target.x - origin.x, target.y - origin.y, target.z - origin.z};
+        const std::array<float, 3> boxMin = {min.x, min.y, min.z}, boxMax = {max.x, max.y, max.z};
+
+        // Only the part of the segment in front of the box matters, whatever is inside belongs to the chunk itself
+        float enter = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            if (delta[i] == 0)
+                continue;
+            const float t0 = (boxMin[i] - start[i]) / delta[i], t1 = (boxMax[i] - start[i]) / delta[i];
+            enter = std::max(enter, std::min(t0, t1));
+        }
+
+        // Step through the blocks along the segment (Amanatides & Woo)
+        std::array<int, 3> block = {static_cast<int>(std::floor(start[0])), static_cast<int>(std::floor(start[1])), static_cast<int>(std::floor(start[2]))};
+        std::array<int, 3> step {};
+        std::array<float, 3> tMax {}, tDelta {};
+        for (int i = 0; i < 3; i++)
+        {
+            step[i] = delta[i] > 0 ? 1 : -1;
+            tDelta[i] = delta[i] != 0 ? std::abs(1.0f / delta[i]) : INFINITY;
+            const float boundary = delta[i] > 0 ? static_cast<float>(block[i] + 1) : static_cast<float>(block[i]);
+            tMax[i] = delta[i] != 0 ? (boundary - start[i]) / delta[i] : INFINITY;
+        }
+
+        float t = 0;
+        while (t < enter - 1e-4f)
+        {
+            if (grid.IsSolid(block[0], block[1], block[2]))
+                return true;
+
+            const int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+            block[axis] += step[axis];
+            t = tMax[axis];
+            tMax[axis] += tDelta[axis];
+        }
+
+        return false;
+    }
+
+    // Points every 8 blocks over the surface of a chunk, corners and edges included
+    static std::vector<Vector3> GetSurfaceSamples(const Vector3 min)
+    {
+        constexpr int spacing = 8;
+        std::vector<Vector3> result;
+        for (int a = 0; a <= CHUNK_WIDTH; a += spacing)
+        {
+            for (int b = 0; b <= CHUNK_WIDTH; b += spacing)
+            {
+                for (int side = 0; side <= 1; side++)
+                {
+                    const auto fa = static_cast<float>(a), fb = static_cast<float>(b);
+                    const auto fw = static_cast<float>(side * CHUNK_WIDTH), fh = static_cast<float>(side * CHUNK_HEIGHT);
+                    result.push_back(Vector3Add(min, Vector3{fw, fa * CHUNK_HEIGHT / CHUNK_WIDTH, fb}));
+                    result.push_back(Vector3Add(min, Vector3{fa, fh, fb}));
+                    result.push_back(Vector3Add(min, Vector3{fa, fb * CHUNK_HEIGHT / CHUNK_WIDTH, fw}));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    int Run()
+    {
+        constexpr int camerasPerHeightfield = 24;
+        std::mt19937 random(42);
+        int failures = 0;
+        for (const auto& [name, block] : GetHeightfields())
+        {
+            const Grid grid(block);
+
+            HorizonCuller culler;
+            culler.Reset(0, 0, columns, columns);
+            for (int cx = 0; cx < columns; cx++)
+            {
+                for (int cz = 0; cz < columns; cz++)
+                {
+                    std::vector<const Chunk*> column;
+                    for (int cy = height - 1; cy >= 0; cy--)
+                        column.push_back(grid.GetChunk(cx, cy, cz));
+                    culler.SetSlab(cx, cz, HorizonCuller::ComputeSlab(column));
+                }
+            }
+
+            // Cameras anywhere in open air, above the terrain or inside caves
+            std::uniform_real_distribution<float> horizontal(0, columns * CHUNK_WIDTH), vertical(0, height * CHUNK_HEIGHT);
+            int cameras = 0, hidden = 0, rays = 0, leaks = 0;
+            while (cameras < camerasPerHeightfield)
+            {
+                const Vector3 cameraPos = {horizontal(random), vertical(random), horizontal(random)};
+                if (grid.IsSolid(static_cast<int>(cameraPos.x), static_cast<int>(cameraPos.y), static_cast<int>(cameraPos.z)))
+                    continue;
+                cameras++;
+
+                culler.SetCamera(cameraPos);
+                for (int cx = 0; cx < columns; cx++)
+                {
+                    for (int cy = 0; cy < height; cy++)
+                    {
+                        for (int cz = 0; cz < columns; cz++)
+                        {
+                            const Vector3 chunkPos = {static_cast<float>(cx), static_cast<float>(cy), static_cast<float>(cz)};
+                            if (!culler.IsHidden(chunkPos))
+                                continue;
+                            hidden++;
+
+                            const Vector3 min = {chunkPos.x * CHUNK_WIDTH, chunkPos.y * CHUNK_HEIGHT, chunkPos.z * CHUNK_WIDTH};
+                            const Vector3 max = Vector3Add(min, Vector3{CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_WIDTH});
+                            for (const Vector3& sample : GetSurfaceSamples(min))
+                            {
+                                rays++;
+                                if (IsBlocked(grid, cameraPos, sample, min, max))
+                                    continue;
+
+                                if (leaks++ < 5)
+                                {
+                                    std::cout << "    " << name << ": chunk " << cx << "," << cy << "," << cz << " hidden but visible from "
+                                              << cameraPos.x << "," << cameraPos.y << "," << cameraPos.z << " at "
+                                              << sample.x << "," << sample.y << "," << sample.z << std::endl;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            const int total = cameras * columns * columns * height;
+            if (leaks == 0)
+            {
+                std::cout << "PASS " << name << " (" << hidden << " of " << total << " chunks hidden, " << rays << " rays blocked)" << std::endl;
+                continue;
+            }
+
+            failures++;
+            std::cout << "FAIL " << name << ": " << leaks << " of " << rays << " rays reach hidden chunks" << std::endl;
+        }
+
+        return failures == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless check that horizon culling is conservative: on synthetic heightfields, every chunk it hides
+// must have all sampled rays from the camera to its surface blocked by a solid block
+namespace HorizonVerifier
+{
+    // Runs every heightfield from a set of cameras and prints the results; returns a process exit code
+    int Run();
+}
@@ -1,37 +1,107 @@
+#include <charconv>
+#include <iostream>
+#include <string>
+
 #include "raylib.h"
+#include "backend.hpp"
 #include "core.hpp"
 #include "rlgl.h"
+#include "arenaverifier.hpp"
+#include "atlasverifier.hpp"
+#include "codecbenchmark.hpp"
+#include "farterrainverifier.hpp"
+#include "governorverifier.hpp"
+#include "headlessrun.hpp"
+#include "horizonverifier.hpp"
+#include "meshbenchmark.hpp"
+#include "meshverifier.hpp"
+#include "regionbenchmark.hpp"
+
+// The optional count after a headless tool's flag, or fallback if there is none. False if it isn't a whole number >= 0.
+static bool ParseCount(const int argc, char** argv, const int fallback, int& count)
+{
+    count = fallback;
+    if (argc <= 2)
+        return true;
+
+    const std::string_view text = argv[2];
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    return error == std::errc() && end == text.data() + text.size() && count >= 0;
+}
 
-int main()
+int main(const int argc, char** argv)
 {
+    // Headless tools, these run without opening a window
+    if (argc > 1 && std::string(argv[1]) == "--verify-mesher")
+        return MeshVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--verify-edits")
+        return MeshVerifier::RunEdits();
+    if (argc > 1 && std::string(argv[1]) == "--verify-horizon")
+        return HorizonVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--verify-arena")
+        return ArenaVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--verify-atlas")
+        return AtlasVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--verify-governor")
+        return GovernorVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--verify-farterrain")
+        return FarTerrainVerifier::Run();
+    if (argc > 1 && std::string(argv[1]) == "--bench-meshing")
+    {
+        int maxThreads;
+        if (!ParseCount(argc, argv, 0, maxThreads))
+        {
+            std::cerr << "Usage: " << argv[0] << " --bench-meshing [max threads, 0 for all cores]" << std::endl;
+            return 1;
+        }
+        return MeshBenchmark::Run(maxThreads);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-regions")
+        return RegionBenchmark::Run();
+    if (argc > 1 && std::string(argv[1]) == "--bench-codec")
+        return CodecBenchmark::Run();
+    if (argc > 1 && std::string(argv[1]) == "--headless")
+    {
+        int frames;
+        if (!ParseCount(argc, argv, 600, frames))
+        {
+            std::cerr << "Usage: " << argv[0] << " --headless [frames]" << std::endl;
+            return 1;
+        }
+        return HeadlessRun::Run(frames);
+    }
+
     const int screenWidth = 1280;
     const int screenHeight = 720;
 
     SetTraceLogLevel(LOG_ERROR);
 
     // Initialize graphics
-    InitWindow(screenWidth, screenHeight, "yippee!!!!!!🪳🪳🪳🪳🪳");
-    SetTargetFPS(60);
+    Backend::InitWindow(screenWidth, screenHeight, "yippee!!!!!!🪳🪳🪳🪳🪳");
+    Backend::SetTargetFPS(60);
     SetConfigFlags(FLAG_MSAA_4X_HINT);
     SetConfigFlags(FLAG_VSYNC_HINT);
 
     // Initialize audio
-    InitAudioDevice();
+    Backend::InitAudioDevice();
 
     // Misc init
     DisableCursor();
     SetExitKey(KEY_NULL);
 
-    Core core;
-    while (!WindowShouldClose())    // Detect window close button or ESC key
+    // Scoped so the simulation thread is joined and the world saved before audio and the window go away
     {
-        core.Update(GetFrameTime());
-        core.Render();
+        Core core;
+        while (!Backend::WindowShouldClose())    // Detect window close button or ESC key
+        {
+            core.Update(Backend::GetFrameTime());
+            core.Render();
+        }
     }
 
-    CloseAudioDevice();
+    Backend::CloseAudioDevice();
 
-    CloseWindow();
+    Backend::CloseWindow();
 
     return 0;
 }
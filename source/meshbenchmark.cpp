@@ -0,0 +1,189 @@
+#include "meshbenchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "chunkfixtures.hpp"
+
+namespace MeshBenchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each measurement meshes for at least this long, and at least minIterations times
+    static constexpr std::chrono::milliseconds minDuration {250};
+    static constexpr int minIterations = 5;
+    static constexpr int voxelsPerChunk = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH;
+
+    // The full resolution mesher and the downsampled ones
+    static constexpr std::array<std::pair<const char*, int>, 3> meshers = {{{"Full", 0}, {"LOD 1", 1}, {"LOD 2", 2}}};
+
+    static std::vector<std::unique_ptr<Chunk>> MakeFixtureChunks()
+    {
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (const auto& fixture : ChunkFixtures::GetFixtures())
+        {
+            chunks.push_back(std::make_unique<Chunk>(nullptr, Vector3{0, 0, 0}));
+            fixture.fill(*chunks.back());
+        }
+
+        return chunks;
+    }
+
+    static void BenchmarkMeshers()
+    {
+        std::cout << std::left << std::setw(18) << "Fixture" << std::setw(8) << "Mesher" << std::right
+                  << std::setw(12) << "ns/voxel" << std::setw(14) << "us/chunk" << std::setw(10) << "vertices"
+                  << std::setw(16) << "Mvertices/s" << std::setw(14) << "KB/mesh" << std::endl;
+
+        const auto chunks = MakeFixtureChunks();
+        const auto& fixtures = ChunkFixtures::GetFixtures();
+        for (int i = 0; i < chunks.size(); i++)
+        {
+            for (const auto& [mesherName, lodLevel] : meshers)
+            {
+                Chunk& chunk = *chunks[i];
+
+                // Warm up once so the first iteration doesn't pay for cold caches
+                chunk.GenerateChunkMesh(lodLevel);
+
+                const size_t bytesBefore = MeshBuffer::allocatedBytes.load();
+                const auto start = Clock::now();
+                int iterations = 0;
+                while (iterations < minIterations || Clock::now() - start < minDuration)
+                {
+                    chunk.GenerateChunkMesh(lodLevel);
+                    iterations++;
+                }
+                const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                const size_t bytes = MeshBuffer::allocatedBytes.load() - bytesBefore;
+
+                const int vertexCount = chunk.mesh->opaque->mesh.vertexCount + chunk.mesh->transparent->mesh.vertexCount;
+                std::cout << std::left << std::setw(18) << fixtures[i].name << std::setw(8) << mesherName << std::right << std::fixed
+                          << std::setprecision(2) << std::setw(12) << seconds * 1e9 / (static_cast<double>(iterations) * voxelsPerChunk)
+                          << std::setw(14) << seconds * 1e6 / iterations
+                          << std::setw(10) << vertexCount
+                          << std::setw(16) << vertexCount * iterations / seconds / 1e6
+                          << std::setw(14) << bytes / 1024.0 / iterations << std::endl;
+            }
+        }
+    }
+
+    // Ambient occlusion is budgeted at under this much extra meshing time, for every fixture on its own
+    static constexpr double maxAmbientOcclusionOverhead = 20;
+
+    // Meshing time per chunk at full resolution, with and without baked ambient occlusion; returns the fixtures over budget
+    static int BenchmarkAmbientOcclusion()
+    {
+        std::cout << std::endl << std::left << std::setw(18) << "Fixture" << std::right << std::setw(14) << "AO us/chunk"
+                  << std::setw(16) << "no AO us/chunk" << std::setw(12) << "overhead" << std::endl;
+
+        const auto chunks = MakeFixtureChunks();
+        const auto& fixtures = ChunkFixtures::GetFixtures();
+        double totalWithAo = 0, totalWithoutAo = 0;
+        int overBudget = 0;
+        for (int i = 0; i < chunks.size(); i++)
+        {
+            // Alternate between the two so both see the same clock speed and cache state
+            Chunk& chunk = *chunks[i];
+            chunk.GenerateChunkMesh(0);
+            std::array<double, 2> seconds {};
+            int iterations = 0;
+            while (iterations < minIterations || seconds[0] + seconds[1] < 2 * std::chrono::duration<double>(minDuration).count())
+            {
+                for (const bool ambientOcclusion : {true, false})
+                {
+                    Chunk::ambientOcclusion = ambientOcclusion;
+                    const auto start = Clock::now();
+                    chunk.GenerateChunkMesh(0);
+                    seconds[ambientOcclusion ? 0 : 1] += std::chrono::duration<double>(Clock::now() - start).count();
+                }
+                iterations++;
+            }
+            const std::array<double, 2> microseconds = {seconds[0] * 1e6 / iterations, seconds[1] * 1e6 / iterations};
+            totalWithAo += microseconds[0];
+            totalWithoutAo += microseconds[1];
+
+            const double overhead = (microseconds[0] / microseconds[1] - 1) * 100;
+            overBudget += overhead < maxAmbientOcclusionOverhead ? 0 : 1;
+            std::cout << std::left << std::setw(18) << fixtures[i].name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << microseconds[0] << std::setw(16) << microseconds[1] << std::setw(11) << overhead << "%"
+                      << (overhead < maxAmbientOcclusionOverhead ? "" : "  over budget") << std::endl;
+        }
+        Chunk::ambientOcclusion = true;
+
+        std::cout << std::left << std::setw(18) << "All fixtures" << std::right << std::setw(14) << totalWithAo
+                  << std::setw(16) << totalWithoutAo << std::setw(11) << (totalWithAo / totalWithoutAo - 1) * 100 << "%" << std::endl;
+        return overBudget;
+    }
+
+    static void BenchmarkThreadScaling(const int maxThreads)
+    {
+        std::cout << std::endl << std::left << std::setw(10) << "Threads" << std::right << std::setw(14) << "chunks/s"
+                  << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << std::endl;
+
+        // Every thread meshes its own copy of all fixtures at full resolution, like the world's chunk threads do
+        double singleThreadRate = 0;
+        for (int threadCount = 1; threadCount <= maxThreads; threadCount = threadCount < maxThreads ? std::min(threadCount * 2, maxThreads) : threadCount + 1)
+        {
+            std::vector<size_t> meshedChunks(threadCount);
+            std::vector<std::thread> threads;
+            const auto start = Clock::now();
+            for (int t = 0; t < threadCount; t++)
+            {
+                threads.emplace_back([&, t]
+                {
+                    const auto chunks = MakeFixtureChunks();
+                    int iterations = 0;
+                    while (iterations < minIterations || Clock::now() - start < minDuration)
+                    {
+                        for (const auto& chunk : chunks)
+                            chunk->GenerateChunkMesh(0);
+                        iterations++;
+                    }
+                    meshedChunks[t] = iterations * chunks.size();
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            size_t totalChunks = 0;
+            for (const size_t count : meshedChunks)
+                totalChunks += count;
+
+            const double rate = totalChunks / seconds;
+            if (threadCount == 1)
+                singleThreadRate = rate;
+
+            std::cout << std::left << std::setw(10) << threadCount << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << rate << std::setw(11) << rate / singleThreadRate << "x"
+                      << std::setw(13) << rate / singleThreadRate / threadCount * 100 << "%" << std::endl;
+        }
+    }
+
+    int Run(int maxThreads)
+    {
+        if (maxThreads <= 0)
+            maxThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+        std::cout << "Meshing benchmark, " << voxelsPerChunk << " voxels per chunk" << std::endl << std::endl;
+        BenchmarkMeshers();
+        const int overBudget = BenchmarkAmbientOcclusion();
+        BenchmarkThreadScaling(maxThreads);
+
+        if (overBudget > 0)
+        {
+            std::cout << std::endl << std::setprecision(0) << "FAIL " << overBudget << " fixtures spent more than " << maxAmbientOcclusionOverhead
+                      << "% extra meshing time on ambient occlusion" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::endl << std::setprecision(0) << "PASS ambient occlusion stayed under " << maxAmbientOcclusionOverhead << "% extra meshing time for every fixture"
+                  << std::endl;
+        return 0;
+    }
+}
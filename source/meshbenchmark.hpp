@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless meshing benchmark over the chunk fixtures, so meshing speed can be tracked without a window or GPU
+namespace MeshBenchmark
+{
+    // Times every mesher on every fixture, then how meshing scales with threads; returns a process exit code, failing when
+    // ambient occlusion goes over its budget on any fixture
+    int Run(int maxThreads = 0);
+}
@@ -0,0 +1,570 @@
+#include "meshverifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <set>
+
+#include "backend.hpp"
+#include "blocktype.hpp"
+#include "chunkfixtures.hpp"
+#include "world.hpp"
+
+namespace MeshVerifier
+{
+    // Axis-aligned unit faces are {0, axis, sign, plane, u, v, tile}, anything else (decals) is
+    // {1, normal..., sorted corners..., tile} with coordinates in thousandths of a block
+    using FaceKey = std::vector<int>;
+    using FaceSet = std::multiset<FaceKey>;
+
+    static int Quantize(const float value)
+    {
+        return static_cast<int>(std::lround(value * 1000.0f));
+    }
+
+    static void CollectFaces(const float* vertices, const float* texcoords, const MeshRange& range, FaceSet& out)
+    {
+        // Every face is a quad made of two triangles
+        for (int first = range.firstVertex; first + 6 <= range.firstVertex + range.vertexCount; first += 6)
+        {
+            std::array<Vector3, 6> positions {};
+            Vector2 texcoordSum {};
+            for (int i = 0; i < 6; i++)
+            {
+                positions[i] = Vector3{vertices[(first + i) * 3], vertices[(first + i) * 3 + 1], vertices[(first + i) * 3 + 2]};
+                texcoordSum = Vector2Add(texcoordSum, Vector2{texcoords[(first + i) * 2], texcoords[(first + i) * 2 + 1]});
+            }
+
+            // Faces removed by edits are collapsed into a point
+            if (std::ranges::all_of(positions, [&](const Vector3 p) { return Vector3Equals(p, positions[0]); }))
+                continue;
+
+            const Vector3 normal = Vector3CrossProduct(Vector3Subtract(positions[1], positions[0]), Vector3Subtract(positions[2], positions[0]));
+            const int tile = static_cast<int>(texcoordSum.x / 6 * BlockType::blockmapWidth) + static_cast<int>(texcoordSum.y / 6 * BlockType::blockmapHeight) * BlockType::blockmapWidth;
+
+            Vector3 min = positions[0], max = positions[0];
+            for (const Vector3& p : positions)
+            {
+                min = Vector3Min(min, p);
+                max = Vector3Max(max, p);
+            }
+
+            const std::array<float, 3> minAxes = {min.x, min.y, min.z}, maxAxes = {max.x, max.y, max.z}, normalAxes = {normal.x, normal.y, normal.z};
+            int axis = -1;
+            for (int i = 0; i < 3; i++)
+            {
+                if (Quantize(minAxes[i]) == Quantize(maxAxes[i]))
+                    axis = i;
+            }
+
+            if (axis < 0)
+            {
+                FaceKey key = {1, Quantize(Vector3Normalize(normal).x), Quantize(Vector3Normalize(normal).y), Quantize(Vector3Normalize(normal).z)};
+                std::vector<std::array<int, 3>> corners;
+                for (const Vector3& p : positions)
+                    corners.push_back({Quantize(p.x), Quantize(p.y), Quantize(p.z)});
+                std::ranges::sort(corners);
+                corners.erase(std::unique(corners.begin(), corners.end()), corners.end());
+                for (const auto& corner : corners)
+                    key.insert(key.end(), corner.begin(), corner.end());
+                key.push_back(tile);
+                out.insert(key);
+                continue;
+            }
+
+            // Split larger quads into unit faces
+            const int tangentA = (axis + 1) % 3, tangentB = (axis + 2) % 3;
+            const int sign = normalAxes[axis] > 0 ? 1 : -1;
+            for (int a = static_cast<int>(std::lround(minAxes[tangentA])); a < std::lround(maxAxes[tangentA]); a++)
+            {
+                for (int b = static_cast<int>(std::lround(minAxes[tangentB])); b < std::lround(maxAxes[tangentB]); b++)
+                {
+                    out.insert({0, axis, sign, static_cast<int>(std::lround(minAxes[axis])), a, b, tile});
+                }
+            }
+        }
+    }
+
+    static FaceSet MeshReference(const Chunk& chunk)
+    {
+        // The original mesher: every model face of every block, unless the neighbor it names is opaque
+        const auto isOccluding = [&](const int x, const int y, const int z)
+        {
+            if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_WIDTH)
+                return false;
+            return !BlockType::Types[chunk.data[x][y][z]].isTransparent;
+        };
+
+        FaceSet result;
+        std::vector<float> vertices, texcoords;
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            for (int y = 0; y < CHUNK_HEIGHT; y++)
+            {
+                for (int z = 0; z < CHUNK_WIDTH; z++)
+                {
+                    const unsigned int blockType = chunk.data[x][y][z];
+                    const BlockModel::Model& model = BlockType::Types[blockType].model;
+                    for (int i = 0; i < model.faces.size(); i++)
+                    {
+                        const BlockModel::BlockFace& face = model.faces[i];
+
+                        bool culled = false;
+                        for (int direction = 0; direction < BlockModel::DirectionCount; direction++)
+                        {
+                            const auto bit = static_cast<BlockModel::Direction>(1 << direction);
+                            const auto [nx, ny, nz] = BlockModel::DirectionToOffset(bit);
+                            if ((face.occlusionNeighbors & static_cast<int>(bit)) && isOccluding(x + nx, y + ny, z + nz))
+                                culled = true;
+                        }
+                        if (culled)
+                            continue;
+
+                        vertices.clear();
+                        texcoords.clear();
+                        for (const auto& vertex : face.vertices)
+                        {
+                            vertices.insert(vertices.end(), {vertex[0] + x, vertex[1] + y, vertex[2] + z});
+                            const auto [u, v] = BlockType::TransformTexcoordsToBlockmap(Vector2{vertex[6], vertex[7]}, i, blockType);
+                            texcoords.insert(texcoords.end(), {u, v});
+                        }
+                        CollectFaces(vertices.data(), texcoords.data(), MeshRange{0, static_cast<int>(face.vertices.size())}, result);
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+    static FaceSet CollectMeshFaces(const ChunkMesh& build)
+    {
+        FaceSet result;
+        const Mesh& opaque = build.opaque->mesh;
+        const Mesh& transparent = build.transparent->mesh;
+        if (opaque.vertices != nullptr)
+        {
+            for (const MeshRange& range : build.opaqueRanges)
+                CollectFaces(opaque.vertices, opaque.texcoords, range, result);
+        }
+        if (transparent.vertices != nullptr)
+            CollectFaces(transparent.vertices, transparent.texcoords, MeshRange{0, transparent.vertexCount}, result);
+
+        // Expand decal instances the way the decal shader does
+        std::vector<float> vertices, texcoords;
+        for (const auto& [x, y, z, textureIndex] : *build.decals)
+        {
+            for (const auto& face : BlockModel::Decal.faces)
+            {
+                vertices.clear();
+                texcoords.clear();
+                for (const auto& vertex : face.vertices)
+                {
+                    vertices.insert(vertices.end(), {vertex[0] + x, vertex[1] + y, vertex[2] + z});
+                    texcoords.insert(texcoords.end(), {(vertex[6] + textureIndex % BlockType::blockmapWidth) / BlockType::blockmapWidth,
+                                                       (vertex[7] + textureIndex / BlockType::blockmapWidth) / BlockType::blockmapHeight});
+                }
+                CollectFaces(vertices.data(), texcoords.data(), MeshRange{0, static_cast<int>(face.vertices.size())}, result);
+            }
+        }
+
+        return result;
+    }
+
+    static FaceSet MeshOptimized(Chunk& chunk)
+    {
+        chunk.GenerateChunkMesh(0);
+        return CollectMeshFaces(*chunk.mesh);
+    }
+
+    static void PrintFace(const FaceKey& key)
+    {
+        std::cout << "        {";
+        for (int i = 0; i < key.size(); i++)
+            std::cout << (i > 0 ? ", " : "") << key[i];
+        std::cout << "}" << std::endl;
+    }
+
+    static int VerifyVisibleDirections()
+    {
+        using enum BlockModel::Direction;
+        constexpr int all = static_cast<int>(Forward) | static_cast<int>(Backward) | static_cast<int>(Left) | static_cast<int>(Right) | static_cast<int>(Up) | static_cast<int>(Down);
+        constexpr float w = CHUNK_WIDTH, h = CHUNK_HEIGHT;
+
+        struct Case
+        {
+            const char* name;
+            Vector3 camera;
+            int expected;
+        };
+        const std::array<Case, 9> cases = {{
+            {"inside", {w / 2, h / 2, w / 2}, all},
+            {"above", {w / 2, h + 10, w / 2}, all & ~static_cast<int>(Down)},
+            {"below", {w / 2, -10, w / 2}, all & ~static_cast<int>(Up)},
+            {"right of", {w + 10, h / 2, w / 2}, all & ~static_cast<int>(Left)},
+            {"left of", {-10, h / 2, w / 2}, all & ~static_cast<int>(Right)},
+            {"in front of", {w / 2, h / 2, w + 10}, all & ~static_cast<int>(Backward)},
+            {"behind", {w / 2, h / 2, -10}, all & ~static_cast<int>(Forward)},
+            {"corner", {w + 10, h + 10, w + 10}, static_cast<int>(Forward) | static_cast<int>(Right) | static_cast<int>(Up)},
+            {"on the right plane", {w, h / 2, w / 2}, all & ~static_cast<int>(Left)},
+        }};
+
+        int failures = 0;
+        for (const auto& [name, camera, expected] : cases)
+        {
+            const int directions = Chunk::GetVisibleDirections(camera, Vector3{0, 0, 0}, Vector3{w, h, w});
+            if (directions == expected)
+                continue;
+            failures++;
+            std::cout << "FAIL visible directions, camera " << name << ": got " << directions << ", expected " << expected << std::endl;
+        }
+        if (failures == 0)
+            std::cout << "PASS visible directions (" << cases.size() << " cameras)" << std::endl;
+
+        return failures;
+    }
+
+    static int VerifyVisibleRanges(const std::string& name, Chunk& chunk)
+    {
+        // Every front-facing opaque face has to be in a drawn range, and only the visible directions are drawn
+        chunk.drawnOpaqueRanges = chunk.mesh->opaqueRanges;
+        const Mesh& opaque = chunk.mesh->opaque->mesh;
+        if (opaque.vertices == nullptr)
+            return 0;
+
+        const std::array<float, 3> xs = {-8, CHUNK_WIDTH / 2.0f + 0.5f, CHUNK_WIDTH + 8}, zs = xs;
+        const std::array<float, 3> ys = {-8, CHUNK_HEIGHT / 2.0f + 0.5f, CHUNK_HEIGHT + 8};
+        int culledFaces = 0;
+        for (const float cx : xs)
+        {
+            for (const float cy : ys)
+            {
+                for (const float cz : zs)
+                {
+                    const Vector3 camera = Vector3Add(chunk.worldPosition, Vector3{cx, cy, cz});
+                    const std::vector<MeshRange> drawn = chunk.GetVisibleOpaqueRanges(camera);
+                    const int directions = Chunk::GetVisibleDirections(camera, chunk.worldPosition,
+                        Vector3Add(chunk.worldPosition, Vector3{CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_WIDTH}));
+
+                    int expectedVertices = 0, drawnVertices = 0;
+                    for (int i = 0; i < chunk.drawnOpaqueRanges.size(); i++)
+                    {
+                        if (i == BlockModel::DirectionCount || (directions & (1 << i)))
+                            expectedVertices += chunk.drawnOpaqueRanges[i].vertexCount;
+                    }
+                    for (const MeshRange& range : drawn)
+                        drawnVertices += range.vertexCount;
+                    if (drawnVertices != expectedVertices)
+                    {
+                        std::cout << "FAIL visible ranges " << name << ": " << drawnVertices << " vertices drawn, expected " << expectedVertices << std::endl;
+                        return 1;
+                    }
+
+                    const auto isDrawn = [&](const int vertex)
+                    {
+                        return std::ranges::any_of(drawn, [&](const MeshRange& range) { return vertex >= range.firstVertex && vertex < range.firstVertex + range.vertexCount; });
+                    };
+                    for (const MeshRange& range : chunk.drawnOpaqueRanges)
+                    {
+                        for (int first = range.firstVertex; first + 6 <= range.firstVertex + range.vertexCount; first += 6)
+                        {
+                            std::array<Vector3, 3> positions {};
+                            for (int i = 0; i < 3; i++)
+                                positions[i] = Vector3Add(chunk.worldPosition, Vector3{opaque.vertices[(first + i) * 3], opaque.vertices[(first + i) * 3 + 1], opaque.vertices[(first + i) * 3 + 2]});
+                            const Vector3 normal = Vector3CrossProduct(Vector3Subtract(positions[1], positions[0]), Vector3Subtract(positions[2], positions[0]));
+                            const bool frontFacing = Vector3DotProduct(normal, Vector3Subtract(camera, positions[0])) > 0.0001f;
+                            if (!isDrawn(first))
+                            {
+                                if (frontFacing)
+                                {
+                                    std::cout << "FAIL visible ranges " << name << ": front-facing face at vertex " << first << " culled, camera "
+                                              << camera.x << ", " << camera.y << ", " << camera.z << std::endl;
+                                    return 1;
+                                }
+                                culledFaces++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::cout << "PASS visible ranges " << name << " (" << culledFaces << " back faces culled over 27 cameras)" << std::endl;
+        return 0;
+    }
+
+    // Prints the differences and returns false when the two sets differ
+    static bool CompareFaces(const std::string& label, const FaceSet& expected, const FaceSet& actual)
+    {
+        std::vector<FaceKey> missing, extra;
+        std::ranges::set_difference(expected, actual, std::back_inserter(missing));
+        std::ranges::set_difference(actual, expected, std::back_inserter(extra));
+        if (missing.empty() && extra.empty())
+            return true;
+
+        std::cout << "FAIL " << label << ": " << missing.size() << " missing, " << extra.size() << " extra faces" << std::endl;
+        for (int i = 0; i < std::min<size_t>(missing.size(), 5); i++)
+        {
+            std::cout << "    missing" << std::endl;
+            PrintFace(missing[i]);
+        }
+        for (int i = 0; i < std::min<size_t>(extra.size(), 5); i++)
+        {
+            std::cout << "    extra" << std::endl;
+            PrintFace(extra[i]);
+        }
+        return false;
+    }
+
+    static int VerifyBorderEdits(const std::string& name, Chunk& chunk)
+    {
+        // Place blocks along the chunk's borders and corners, some next to each other, then take them out again in reverse.
+        // Every edit is patched the way World::SetBlockAt does it and has to match a full remesh of the same blocks.
+        constexpr int last = CHUNK_WIDTH - 1, top = CHUNK_HEIGHT - 1;
+        constexpr std::array<std::array<int, 3>, 12> positions = {{
+            {0, 0, 0}, {1, 0, 0}, {last, 0, 0}, {0, top, 0}, {1, top, 0}, {0, 0, last}, {last, top, last},
+            {last / 2, 0, 0}, {0, top / 2, last}, {last, top, last / 2}, {last / 2, top, last / 2}, {last, top - 1, last / 2},
+        }};
+        constexpr std::array<unsigned char, 4> placedTypes = {4, 2, 10, 6}; // Stone, dirt, flower, glass
+
+        std::array<unsigned char, positions.size()> original {};
+        int edits = 0, patchedEdits = 0;
+        const auto edit = [&](const std::array<int, 3>& position, const unsigned char blockType)
+        {
+            const auto [x, y, z] = position;
+            const unsigned char oldBlockType = chunk.data[x][y][z];
+            if (oldBlockType == blockType)
+                return true;
+            chunk.data[x][y][z] = blockType;
+            edits++;
+
+            const bool transparentChanged = BlockType::GetRenderPass(oldBlockType) == BlockType::RenderPass::Translucent ||
+                                            BlockType::GetRenderPass(blockType) == BlockType::RenderPass::Translucent;
+            if (!transparentChanged && chunk.PatchBlockFaces(x, y, z))
+                patchedEdits++;
+            else
+                chunk.GenerateChunkMesh(0);
+
+            Chunk fresh(nullptr, chunk.position);
+            fresh.data = chunk.data;
+            fresh.GenerateChunkMesh(0);
+            return CompareFaces("border edits " + name + ", edit " + std::to_string(edits) + " at " + std::to_string(x) + ", " +
+                                std::to_string(y) + ", " + std::to_string(z), CollectMeshFaces(*fresh.mesh), CollectMeshFaces(*chunk.mesh));
+        };
+
+        bool matching = true;
+        for (int i = 0; i < positions.size() && matching; i++)
+        {
+            const auto [x, y, z] = positions[i];
+            original[i] = chunk.data[x][y][z];
+            const unsigned char placed = placedTypes[i % placedTypes.size()];
+            matching = edit(positions[i], original[i] == placed ? 0 : placed);
+        }
+        for (int i = static_cast<int>(positions.size()) - 1; i >= 0 && matching; i--)
+            matching = edit(positions[i], original[i]);
+
+        if (!matching)
+            return 1;
+        std::cout << "PASS border edits " << name << " (" << edits << " edits, " << patchedEdits << " patched in place)" << std::endl;
+        return 0;
+    }
+
+    static int VerifyLodMeshes(const std::string& name, Chunk& chunk)
+    {
+        // Every level has to show the surface the reference mesher finds when each cell is filled in at full resolution.
+        // A cell is solid when at least half of it is opaque and takes the type of its topmost opaque block, the first
+        // one in x, z order when several share the top layer.
+        int faceCount = 0;
+        for (int level = 1; level <= 3; level++)
+        {
+            const int scale = 1 << level;
+            const auto upscaled = std::make_unique<Chunk>(nullptr, chunk.position);
+            for (int cellX = 0; cellX < CHUNK_WIDTH / scale; cellX++)
+            {
+                for (int cellY = 0; cellY < CHUNK_HEIGHT / scale; cellY++)
+                {
+                    for (int cellZ = 0; cellZ < CHUNK_WIDTH / scale; cellZ++)
+                    {
+                        int opaqueCount = 0, topY = -1;
+                        unsigned char topType = 0;
+                        for (int x = cellX * scale; x < (cellX + 1) * scale; x++)
+                        {
+                            for (int y = cellY * scale; y < (cellY + 1) * scale; y++)
+                            {
+                                for (int z = cellZ * scale; z < (cellZ + 1) * scale; z++)
+                                {
+                                    if (BlockType::Types[chunk.data[x][y][z]].isTransparent)
+                                        continue;
+                                    opaqueCount++;
+                                    if (y > topY)
+                                    {
+                                        topY = y;
+                                        topType = chunk.data[x][y][z];
+                                    }
+                                }
+                            }
+                        }
+
+                        const unsigned char cellType = opaqueCount * 2 >= scale * scale * scale ? topType : 0;
+                        for (int x = cellX * scale; x < (cellX + 1) * scale; x++)
+                            for (int y = cellY * scale; y < (cellY + 1) * scale; y++)
+                                for (int z = cellZ * scale; z < (cellZ + 1) * scale; z++)
+                                    upscaled->data[x][y][z] = cellType;
+                    }
+                }
+            }
+
+            const FaceSet reference = MeshReference(*upscaled);
+            chunk.GenerateChunkMesh(level);
+            if (!CompareFaces("LOD " + std::to_string(level) + " " + name, reference, CollectMeshFaces(*chunk.mesh)))
+                return 1;
+            faceCount += static_cast<int>(reference.size());
+        }
+
+        chunk.GenerateChunkMesh(0);
+        std::cout << "PASS LOD " << name << " (" << faceCount << " faces over levels 1 to 3)" << std::endl;
+        return 0;
+    }
+
+    int Run()
+    {
+        int failures = VerifyVisibleDirections();
+        for (const auto& [name, fill] : ChunkFixtures::GetFixtures())
+        {
+            const auto chunk = std::make_unique<Chunk>(nullptr, Vector3{0, 0, 0});
+            fill(*chunk);
+
+            const FaceSet reference = MeshReference(*chunk);
+            const FaceSet optimized = MeshOptimized(*chunk);
+            if (CompareFaces(name, reference, optimized))
+                std::cout << "PASS " << name << " (" << reference.size() << " faces)" << std::endl;
+            else
+                failures++;
+
+            failures += VerifyVisibleRanges(name, *chunk);
+            failures += VerifyBorderEdits(name, *chunk);
+            failures += VerifyLodMeshes(name, *chunk);
+        }
+
+        return failures == 0 ? 0 : 1;
+    }
+
+    int RunEdits()
+    {
+        SetTraceLogLevel(LOG_ERROR);
+        Backend::UseNull();
+
+        const std::filesystem::path saveDirectory = std::filesystem::temp_directory_path() / "minecraylib-edits";
+        std::filesystem::remove_all(saveDirectory);
+
+        // A small world around the origin, so edits land on chunk borders at negative coordinates too. The terrain
+        // surface lies between y 200 and 264, inside the layers loaded around y 224.
+        constexpr int editCount = 200;
+        constexpr int editRange = CHUNK_WIDTH; // Blocks from the origin, within the full resolution chunks
+        constexpr int vertexBytes = 3 * sizeof(float) + 3 * sizeof(float) + 2 * sizeof(float) + 4;
+        int failures = 0;
+        {
+            World world(Vector3{0, 224, 0}, saveDirectory, 3);
+
+            std::mt19937 random(1234);
+            const auto pick = [&](const int min, const int max) { return std::uniform_int_distribution(min, max)(random); };
+            const std::array<unsigned char, 8> blockTypes = {0, 0, 0, 1, 2, 4, 6, 10}; // Air, grass, dirt, stone, glass, flower
+            const std::array<int, 4> borders = {-editRange, -1, 0, editRange - 1};
+
+            int changedBlocks = 0, patchedEdits = 0;
+            size_t patchedBytes = 0;
+            for (int edit = 0; edit < editCount && failures == 0; edit++)
+            {
+                // Half the edits sit on a chunk border in x or z, some on one in y
+                int x = pick(-editRange, editRange - 1), z = pick(-editRange, editRange - 1);
+                if (pick(0, 1) == 0)
+                    (pick(0, 1) == 0 ? x : z) = borders[pick(0, 3)];
+                int y = world.GetTerrainHeight(x, z) + pick(-3, 2);
+                if (pick(0, 3) == 0)
+                    y = (y + CHUNK_HEIGHT / 2) / CHUNK_HEIGHT * CHUNK_HEIGHT - pick(0, 1);
+
+                const std::shared_ptr<Chunk> edited = world.GetChunkAt(World::GetChunkPositionAt(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}));
+                const uint64_t previousId = edited->mesh->id;
+                const unsigned char blockType = blockTypes[pick(0, blockTypes.size() - 1)];
+                if (world.GetBlockAt(x, y, z) != blockType)
+                    changedBlocks++;
+                world.SetBlockAt(x, y, z, blockType);
+                if (edited->mesh->id != previousId && edited->mesh->patchedFrom == previousId)
+                {
+                    patchedEdits++;
+                    for (const MeshRange& range : edited->mesh->patchedRanges)
+                        patchedBytes += range.vertexCount * vertexBytes;
+                }
+
+                // Every chunk around the edit, patched or rebuilt, has to look like a chunk meshed from scratch
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    for (int dy = -1; dy <= 1; dy++)
+                    {
+                        for (int dz = -1; dz <= 1; dz++)
+                        {
+                            const std::shared_ptr<Chunk> chunk = world.GetChunkAt(Vector3Add(edited->position, Vector3{static_cast<float>(dx), static_cast<float>(dy), static_cast<float>(dz)}));
+                            if (chunk == nullptr || chunk->mesh == nullptr)
+                                continue;
+
+                            Chunk fresh(&world, chunk->position);
+                            fresh.data = chunk->data;
+                            fresh.GenerateChunkMesh(chunk->lodLevel, chunk->lodSeams);
+
+                            const FaceSet expected = CollectMeshFaces(*fresh.mesh);
+                            const FaceSet actual = CollectMeshFaces(*chunk->mesh);
+                            if (expected == actual)
+                                continue;
+
+                            std::vector<FaceKey> missing, extra;
+                            std::ranges::set_difference(expected, actual, std::back_inserter(missing));
+                            std::ranges::set_difference(actual, expected, std::back_inserter(extra));
+                            std::cout << "FAIL edit " << edit + 1 << " at " << x << ", " << y << ", " << z << ": chunk " << chunk->position.x << ", "
+                                      << chunk->position.y << ", " << chunk->position.z << " has " << missing.size() << " missing, " << extra.size()
+                                      << " extra faces" << std::endl;
+                            failures++;
+                        }
+                    }
+                }
+            }
+
+            if (failures == 0)
+            {
+                std::cout << "PASS " << editCount << " random edits (" << changedBlocks << " changed a block, " << patchedEdits << " patched in place, "
+                          << (patchedEdits > 0 ? patchedBytes / patchedEdits : 0) << " bytes of vertices per patch)" << std::endl;
+            }
+
+            // Rays into the terrain stop at its surface, with the air block above it to place into
+            std::array<int, 3> hit {}, previous {};
+            const int surface = world.GetTerrainHeight(5, 7);
+            world.SetBlockAt(5, surface, 7, 4);
+            for (int y = surface + 1; y <= surface + 4; y++)
+                world.SetBlockAt(5, y, 7, 0);
+            if (!world.RaycastBlock(Vector3{5.5f, surface + 4.5f, 7.5f}, Vector3{0, -1, 0}, 8, hit, previous) ||
+                hit != std::array{5, surface, 7} || previous != std::array{5, surface + 1, 7})
+            {
+                std::cout << "FAIL raycast onto the surface" << std::endl;
+                failures++;
+            }
+            else if (world.RaycastBlock(Vector3{5.5f, surface + 0.5f, 7.5f}, Vector3{0, -1, 0}, 8, hit, previous))
+            {
+                std::cout << "FAIL raycast from inside a block" << std::endl;
+                failures++;
+            }
+            else if (world.RaycastBlock(Vector3{5.5f, surface + 4.5f, 7.5f}, Vector3{0, -1, 0}, 2, hit, previous))
+            {
+                std::cout << "FAIL raycast beyond its distance" << std::endl;
+                failures++;
+            }
+            else
+            {
+                std::cout << "PASS raycasts" << std::endl;
+            }
+        }
+
+        std::filesystem::remove_all(saveDirectory);
+        return failures == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// Headless check that the optimized mesher produces the same visible surface as a plain reference mesher,
+// compared as sets of oriented, textured unit faces so merging or reordering faces doesn't matter
+// Also checks that per-direction culling of opaque ranges never drops a face the camera can see, that edits patched
+// into a mesh match a full remesh, and that LOD meshes match the reference mesher run on the downsampled blocks
+namespace MeshVerifier
+{
+    // Meshes every fixture both ways and prints the differences; returns a process exit code
+    int Run();
+    // Makes random block edits in a small world, around chunk borders, and compares every chunk around each one
+    // with a fresh remesh; returns a process exit code
+    int RunEdits();
+}
@@ -0,0 +1,169 @@
+#include "regionbenchmark.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "regionstore.hpp"
+#include "terraingenerator.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RegionBenchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Chunks around the surface, which the world's terrain keeps between y 200 and 264
+    static constexpr int sizeX = 8, minY = 5, maxY = 8, sizeZ = 8;
+    static constexpr int editedChunks = 16;
+
+    static std::vector<std::unique_ptr<Chunk>> MakeChunks()
+    {
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (int x = 0; x < sizeX; x++)
+            for (int y = minY; y <= maxY; y++)
+                for (int z = 0; z < sizeZ; z++)
+                    chunks.push_back(std::make_unique<Chunk>(nullptr, Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}));
+        return chunks;
+    }
+
+    static void PrintRow(const char* name, const size_t chunkCount, const double seconds, const double baselineSeconds)
+    {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << chunkCount / seconds << std::setw(14) << seconds * 1e6 / chunkCount
+                  << std::setw(11) << baselineSeconds / seconds << "x" << std::endl;
+    }
+
+    // Loads every chunk and compares it with the original; returns the seconds it took
+    static double LoadAll(RegionStore& store, const std::vector<std::unique_ptr<Chunk>>& originals, int& mismatches)
+    {
+        const auto loaded = MakeChunks();
+        const auto start = Clock::now();
+
+        // Asked for all at once like the world does, so the disk isn't kept waiting on one payload at a time
+        for (const auto& chunk : loaded)
+            store.Prefetch(chunk->position);
+        for (const auto& chunk : loaded)
+        {
+            if (!store.Load(*chunk))
+                mismatches++;
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        for (size_t i = 0; i < loaded.size(); i++)
+        {
+            if (loaded[i]->data != originals[i]->data)
+                mismatches++;
+        }
+
+        return seconds;
+    }
+
+    // Pushes the region files out of the page cache, so the next reads go to the disk; false where that isn't possible
+    static bool DropCachedPages(const std::filesystem::path& directory)
+    {
+#if defined(POSIX_FADV_DONTNEED)
+        bool dropped = true;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            // Dirty pages stay, so they are written out first
+            const int fd = open(entry.path().c_str(), O_RDONLY);
+            dropped = fd >= 0 && fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0 && dropped;
+            if (fd >= 0)
+                close(fd);
+        }
+        return dropped;
+#else
+        return false;
+#endif
+    }
+
+    // Loads from a freshly opened store, with its files in or out of the page cache
+    static void BenchmarkLoad(const char* name, const std::filesystem::path& directory, const bool mapped, const bool cold,
+                              const std::vector<std::unique_ptr<Chunk>>& originals, const double generateSeconds, int& mismatches)
+    {
+        if (cold && !DropCachedPages(directory))
+        {
+            std::cout << std::left << std::setw(22) << name << "skipped, the page cache can't be dropped here" << std::endl;
+            return;
+        }
+
+        RegionStore store(directory);
+        store.SetMappedReads(mapped);
+        PrintRow(name, originals.size(), LoadAll(store, originals, mismatches), generateSeconds);
+    }
+
+    int Run()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "minecraylib-region-benchmark";
+        std::filesystem::remove_all(directory);
+
+        const TerrainGenerator terrain(12345);
+        const auto chunks = MakeChunks();
+        std::cout << "Region file benchmark, " << chunks.size() << " generated chunks" << std::endl << std::endl;
+        std::cout << std::left << std::setw(22) << "Operation" << std::right << std::setw(14) << "chunks/s"
+                  << std::setw(14) << "us/chunk" << std::setw(12) << "vs gen" << std::endl;
+
+        auto start = Clock::now();
+        for (const auto& chunk : chunks)
+            terrain.Generate(*chunk);
+        const double generateSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        PrintRow("Generate", chunks.size(), generateSeconds, generateSeconds);
+
+        RegionStore::Stats saved;
+        {
+            RegionStore store(directory);
+            start = Clock::now();
+            for (const auto& chunk : chunks)
+                store.Save(*chunk);
+            PrintRow("Save", chunks.size(), std::chrono::duration<double>(Clock::now() - start).count(), generateSeconds);
+            saved = store.GetStats();
+        }
+
+        // Buffered reads copy every payload out before decoding, mapped ones decode it where the page cache holds it
+        int mismatches = 0;
+        BenchmarkLoad("Load buffered, cold", directory, false, true, chunks, generateSeconds, mismatches);
+        BenchmarkLoad("Load mapped, cold", directory, true, true, chunks, generateSeconds, mismatches);
+        BenchmarkLoad("Load buffered, warm", directory, false, false, chunks, generateSeconds, mismatches);
+        BenchmarkLoad("Load mapped, warm", directory, true, false, chunks, generateSeconds, mismatches);
+
+        // Edits grow some payloads past their sectors, those move and leave holes behind for later rewrites to reuse.
+        // Moved ones land past the end of the mapping, which has to be remapped to load them again.
+        RegionStore::Stats rewritten;
+        {
+            RegionStore store(directory);
+            LoadAll(store, chunks, mismatches);
+            for (int i = 0; i < editedChunks; i++)
+            {
+                Chunk& chunk = *chunks[i * chunks.size() / editedChunks];
+                for (int x = 0; x < CHUNK_WIDTH; x++)
+                    for (int z = 0; z < CHUNK_WIDTH; z++)
+                        chunk.data[x][(x * 7 + z * 3) % CHUNK_HEIGHT][z] = (x + z) % 14;
+                store.Save(chunk);
+            }
+            LoadAll(store, chunks, mismatches);
+            rewritten = store.GetStats();
+        }
+
+        std::cout << std::endl << "Payloads: " << saved.bytesWritten / chunks.size() << " bytes per chunk on average, "
+                  << CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH << " blocks" << std::endl;
+        std::cout << "Files: " << saved.regions << " regions, " << saved.fileBytes / 1024 << " KB, " << rewritten.fileBytes / 1024
+                  << " KB after rewriting " << editedChunks << " edited chunks" << std::endl;
+        std::filesystem::remove_all(directory);
+
+        if (mismatches > 0)
+        {
+            std::cout << "FAIL " << mismatches << " chunks did not load back as saved" << std::endl;
+            return 1;
+        }
+
+        std::cout << "PASS every chunk loaded back as saved" << std::endl;
+        return 0;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Headless benchmark of saving generated terrain to region files and loading it back, mapped and buffered, with the
+// files in and out of the page cache, against generating it again
+namespace RegionBenchmark
+{
+    // Generates, saves and reloads a block of chunks, checking every reload; returns a process exit code
+    int Run();
+}
@@ -0,0 +1,333 @@
+#include "regionfile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Numbers are stored little endian, whatever the machine
+static void PutUint32(unsigned char* out, const uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static uint32_t GetUint32(const unsigned char* in)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+uint32_t RegionFile::TableEntry::GetSectorCount() const
+{
+    return static_cast<uint32_t>((byteCount + sectorBytes - 1) / sectorBytes);
+}
+
+RegionFile::RegionFile(const std::filesystem::path& path) : table(chunkCount)
+{
+    file = std::fopen(path.string().c_str(), "r+b");
+    const bool loaded = file != nullptr ? LoadHeader() : (file = std::fopen(path.string().c_str(), "w+b")) != nullptr && Create();
+    if (!loaded || !Map())
+    {
+        std::cout << "Region file " << path << " can't be used, its chunks are generated again" << std::endl;
+        if (file != nullptr)
+            std::fclose(file);
+        file = nullptr;
+    }
+}
+
+RegionFile::~RegionFile()
+{
+    Unmap();
+    if (file != nullptr)
+        std::fclose(file);
+}
+
+bool RegionFile::IsOpen() const
+{
+    return file != nullptr;
+}
+
+int RegionFile::GetChunkIndex(const int x, const int y, const int z)
+{
+    return (x * chunksPerAxis + y) * chunksPerAxis + z;
+}
+
+bool RegionFile::Create()
+{
+    // An empty table, padded out to whole sectors
+    std::vector<unsigned char> header(headerSectors * sectorBytes);
+    PutUint32(header.data(), magic);
+    PutUint32(header.data() + 4, version);
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size() || std::fflush(file) != 0)
+        return false;
+
+    usedSectors.assign(headerSectors, true);
+    return true;
+}
+
+bool RegionFile::LoadHeader()
+{
+    std::vector<unsigned char> header(headerSectors * sectorBytes);
+    if (std::fread(header.data(), 1, header.size(), file) != header.size() || GetUint32(header.data()) != magic || GetUint32(header.data() + 4) != version)
+        return false;
+
+    if (std::fseek(file, 0, SEEK_END) != 0)
+        return false;
+    const long fileBytes = std::ftell(file);
+    if (fileBytes < 0)
+        return false;
+
+    usedSectors.assign(std::max<size_t>((fileBytes + sectorBytes - 1) / sectorBytes, headerSectors), false);
+    std::fill_n(usedSectors.begin(), headerSectors, true);
+    for (int i = 0; i < chunkCount; i++)
+    {
+        const unsigned char* stored = header.data() + preambleBytes + i * tableEntryBytes;
+        TableEntry entry {GetUint32(stored), GetUint32(stored + 4)};
+
+        // Payloads cut short by the end of the file or overlapping the header count as never saved
+        if (entry.firstSector < headerSectors || entry.byteCount == 0 || entry.firstSector + entry.GetSectorCount() > usedSectors.size())
+            continue;
+
+        table[i] = entry;
+        MarkSectors(entry, true);
+    }
+
+    return true;
+}
+
+bool RegionFile::Map()
+{
+#if defined(_WIN32)
+    // No mapping here, mapped reads fall back to buffered ones
+    return true;
+#else
+    struct stat status {};
+    if (fstat(fileno(file), &status) != 0)
+        return false;
+
+    Unmap();
+    const auto bytes = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fileno(file), 0);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    // Chunks are read scattered all over the file, readahead past a payload would mostly fetch chunks nobody asked for
+    madvise(mapped, bytes, MADV_RANDOM);
+    mapping = static_cast<const unsigned char*>(mapped);
+    mappedBytes = bytes;
+    return true;
+#endif
+}
+
+void RegionFile::Unmap()
+{
+#if !defined(_WIN32)
+    if (mapping != nullptr)
+        munmap(const_cast<unsigned char*>(mapping), mappedBytes);
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+}
+
+bool RegionFile::Has(const int index) const
+{
+    std::shared_lock lock(mutex);
+    return table[index].firstSector != 0;
+}
+
+bool RegionFile::Read(const int index, const PayloadReader& read)
+{
+#if defined(_WIN32)
+    std::vector<unsigned char> payload;
+    return Read(index, payload) && read(payload.data(), payload.size());
+#else
+    // Written since the last flush, or past the end of the mapping since it was made. Flushed and remapped while nobody
+    // reads from the old mapping. Another write can slip in while the lock is switched back, so check again until the
+    // shared lock finds everything flushed and the entry mapped; any version of the entry is fine then.
+    std::shared_lock lock(mutex);
+    while (true)
+    {
+        if (file == nullptr || table[index].firstSector == 0)
+            return false;
+        if (!unflushed && table[index].firstSector * sectorBytes + table[index].byteCount <= mappedBytes)
+            break;
+
+        lock.unlock();
+        {
+            std::unique_lock exclusive(mutex);
+            if (unflushed && std::fflush(file) != 0)
+                return false;
+            unflushed = false;
+            if (table[index].firstSector * sectorBytes + table[index].byteCount > mappedBytes && !Map())
+                return false;
+        }
+        lock.lock();
+    }
+
+    const TableEntry entry = table[index];
+
+    mappedReads++;
+    mappedBytesRead += entry.byteCount;
+    return read(mapping + entry.firstSector * sectorBytes, entry.byteCount);
+#endif
+}
+
+void RegionFile::Prefetch(const int index) const
+{
+#if !defined(_WIN32)
+    std::shared_lock lock(mutex);
+    const TableEntry entry = table[index];
+    if (entry.firstSector == 0 || entry.firstSector * sectorBytes + entry.byteCount > mappedBytes)
+        return;
+
+    // Payloads start on sector boundaries, which only line up with pages when those aren't any bigger
+    static const auto pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = entry.firstSector * sectorBytes / pageBytes * pageBytes;
+    madvise(const_cast<unsigned char*>(mapping) + start, entry.firstSector * sectorBytes + entry.byteCount - start, MADV_WILLNEED);
+#endif
+}
+
+bool RegionFile::Read(const int index, std::vector<unsigned char>& payload)
+{
+    std::unique_lock lock(mutex);
+
+    const TableEntry entry = table[index];
+    if (file == nullptr || entry.firstSector == 0)
+        return false;
+
+    payload.resize(entry.byteCount);
+    if (std::fseek(file, static_cast<long>(entry.firstSector * sectorBytes), SEEK_SET) != 0 ||
+        std::fread(payload.data(), 1, payload.size(), file) != payload.size())
+        return false;
+
+    stats.reads++;
+    stats.bytesRead += payload.size();
+    return true;
+}
+
+bool RegionFile::Write(const int index, const std::vector<unsigned char>& payload)
+{
+    std::unique_lock lock(mutex);
+
+    if (file == nullptr || payload.empty())
+        return false;
+
+    // The old copy stays where it is until the new one is complete
+    TableEntry entry {0, static_cast<uint32_t>(payload.size())};
+    const uint32_t sectorCount = entry.GetSectorCount();
+    entry.firstSector = FindFreeSectors(sectorCount);
+
+    // Zero padding keeps the file a whole number of sectors long
+    static constexpr std::array<unsigned char, sectorBytes> padding {};
+    const size_t paddingBytes = sectorCount * sectorBytes - payload.size();
+    if (std::fseek(file, static_cast<long>(entry.firstSector * sectorBytes), SEEK_SET) != 0 ||
+        std::fwrite(payload.data(), 1, payload.size(), file) != payload.size() ||
+        std::fwrite(padding.data(), 1, paddingBytes, file) != paddingBytes)
+        return false;
+
+    // The payload goes out ahead of the table entry pointing at it
+    if (std::fflush(file) != 0)
+        return false;
+
+    const TableEntry previous = table[index];
+    if (usedSectors.size() < entry.firstSector + sectorCount)
+        usedSectors.resize(entry.firstSector + sectorCount, false);
+    MarkSectors(entry, true);
+    table[index] = entry;
+    if (!WriteTableEntry(index))
+    {
+        table[index] = previous;
+        MarkSectors(entry, false);
+        return false;
+    }
+    if (previous.firstSector != 0)
+        replaced.push_back(previous);
+    unflushed = true;
+
+    stats.writes++;
+    stats.bytesWritten += payload.size();
+    return true;
+}
+
+bool RegionFile::WriteTableEntry(const int index)
+{
+    std::array<unsigned char, tableEntryBytes> stored {};
+    PutUint32(stored.data(), table[index].firstSector);
+    PutUint32(stored.data() + 4, table[index].byteCount);
+
+    return std::fseek(file, static_cast<long>(preambleBytes + index * tableEntryBytes), SEEK_SET) == 0 &&
+           std::fwrite(stored.data(), 1, stored.size(), file) == stored.size();
+}
+
+bool RegionFile::Flush()
+{
+    std::unique_lock lock(mutex);
+
+    // Mapped reads may have flushed the writes already, the replaced copies still wait for the sync
+    if (file == nullptr || (!unflushed && replaced.empty()))
+        return true;
+
+    unflushed = false;
+#if defined(_WIN32)
+    const bool flushed = std::fflush(file) == 0;
+#else
+    const bool flushed = std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+#endif
+    if (!flushed)
+        return false;
+
+    // The table on disk no longer points at the replaced copies
+    for (const TableEntry& entry : replaced)
+        MarkSectors(entry, false);
+    replaced.clear();
+    return true;
+}
+
+uint32_t RegionFile::FindFreeSectors(const uint32_t count) const
+{
+    // First run of free sectors that is long enough, else past the end of the file
+    uint32_t runStart = headerSectors, runLength = 0;
+    for (uint32_t sector = headerSectors; sector < usedSectors.size(); sector++)
+    {
+        if (usedSectors[sector])
+        {
+            runStart = sector + 1;
+            runLength = 0;
+            continue;
+        }
+
+        if (++runLength == count)
+            return runStart;
+    }
+
+    // A free run at the end of the file just grows
+    return runStart;
+}
+
+void RegionFile::MarkSectors(const TableEntry& entry, const bool used)
+{
+    if (entry.firstSector == 0)
+        return;
+
+    std::fill_n(usedSectors.begin() + entry.firstSector, entry.GetSectorCount(), used);
+}
+
+RegionFile::Stats RegionFile::GetStats() const
+{
+    std::shared_lock lock(mutex);
+
+    Stats result = stats;
+    result.reads += mappedReads;
+    result.bytesRead += mappedBytesRead;
+    result.sectors = usedSectors.size();
+    result.usedSectors = std::ranges::count(usedSectors, true);
+    return result;
+}
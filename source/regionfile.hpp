@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+// One file holding the saved chunks of a chunksPerAxis^3 region. A header table gives the first sector and byte length
+// of every chunk's payload, payloads start on sector boundaries. A rewritten chunk goes to free sectors or the end of
+// the file and its table entry is only switched over once the payload has been handed to the OS, so an interrupted
+// write leaves the old copy intact. The old copy's sectors are only reused after the next Flush(), which also syncs the
+// file to disk, so the table on disk never points at sectors that were written over.
+// Reads go through a read-only mapping of the whole file, so payloads are decoded where the page cache holds them.
+// Table entries stay buffered until Flush(), or until a mapped read needs them.
+class RegionFile
+{
+    public:
+        static constexpr int chunksPerAxis = 16;
+        static constexpr int chunkCount = chunksPerAxis * chunksPerAxis * chunksPerAxis;
+        static constexpr size_t sectorBytes = 4096;
+
+        // Handed a payload in place; returns whether it could make sense of it
+        using PayloadReader = std::function<bool(const unsigned char* payload, size_t size)>;
+
+        struct Stats
+        {
+            unsigned long reads = 0, writes = 0;
+            size_t bytesRead = 0, bytesWritten = 0; // Payloads only
+            size_t sectors = 0, usedSectors = 0;    // Of the whole file, header included
+        };
+
+        // Opens the file, or creates an empty one if there is none. IsOpen() tells whether that worked.
+        explicit RegionFile(const std::filesystem::path& path);
+        ~RegionFile();
+        RegionFile(const RegionFile&) = delete;
+        RegionFile& operator=(const RegionFile&) = delete;
+
+        [[nodiscard]] bool IsOpen() const;
+        // Index of a chunk by its position inside the region, every coordinate in [0, chunksPerAxis)
+        [[nodiscard]] static int GetChunkIndex(int x, int y, int z);
+
+        // Any thread. Reads return false if the chunk was never saved.
+        [[nodiscard]] bool Has(int index) const;
+        // From the mapping, any number of threads at once. The payload is only valid during the call.
+        bool Read(int index, const PayloadReader& read);
+        // Copies the payload out with buffered reads instead, one thread at a time
+        bool Read(int index, std::vector<unsigned char>& payload);
+        bool Write(int index, const std::vector<unsigned char>& payload);
+        // Hands buffered writes to the OS
+        bool Flush();
+        // Asks the OS to start reading the chunk's payload in, for chunks that are about to be read
+        void Prefetch(int index) const;
+
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        struct TableEntry
+        {
+            uint32_t firstSector = 0; // 0 for chunks that were never saved, the header comes first
+            uint32_t byteCount = 0;
+
+            [[nodiscard]] uint32_t GetSectorCount() const;
+        };
+
+        static constexpr uint32_t magic = 0x4752434D; // "MCRG"
+        static constexpr uint32_t version = 1;
+        static constexpr size_t preambleBytes = 8;    // Magic and version, then the table
+        static constexpr size_t tableEntryBytes = 8;
+        static constexpr uint32_t headerSectors = (preambleBytes + chunkCount * tableEntryBytes + sectorBytes - 1) / sectorBytes;
+
+        std::FILE* file = nullptr;
+        std::vector<TableEntry> table;
+        std::vector<bool> usedSectors; // One per sector of the file
+        Stats stats;
+        std::atomic<unsigned long> mappedReads = 0;
+        std::atomic<size_t> mappedBytesRead = 0;
+
+        // Covers the file as it was when last mapped. Writes are seen through it, growth needs a new mapping.
+        const unsigned char* mapping = nullptr;
+        size_t mappedBytes = 0;
+        bool unflushed = false; // Written since the last flush, which the mapping can't see yet
+        std::vector<TableEntry> replaced; // Sectors of copies rewritten since the last flush, still reserved
+
+        // Shared by mapped reads, everything else is exclusive
+        mutable std::shared_mutex mutex;
+
+        bool Create();
+        bool LoadHeader();
+        bool Map();
+        void Unmap();
+        bool WriteTableEntry(int index);
+        [[nodiscard]] uint32_t FindFreeSectors(uint32_t count) const;
+        void MarkSectors(const TableEntry& entry, bool used);
+};
@@ -0,0 +1,212 @@
+#include "regionstore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "chunkcodec.hpp"
+#include "raymath.h"
+
+RegionStore::RegionStore(std::filesystem::path directory) : directory(std::move(directory))
+{
+    // Saves fail on their own if this does
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+}
+
+uint64_t RegionStore::LoadSeed(const uint64_t fallback)
+{
+    const std::filesystem::path path = directory / "seed";
+    uint64_t seed = fallback;
+    if (std::ifstream in(path); in >> seed)
+        return seed;
+
+    std::ofstream(path) << fallback << std::endl;
+    return fallback;
+}
+
+bool RegionStore::Load(Chunk& chunk)
+{
+    RegionFile* region = GetRegion(chunk.position, false);
+    if (region == nullptr)
+        return false;
+
+    // A damaged payload is as good as none, the chunk is generated again
+    size_t payloadBytes = 0;
+    const auto decode = [&chunk, &payloadBytes](const unsigned char* payload, const size_t size)
+    {
+        payloadBytes = size;
+        return ChunkCodec::Decode(payload, size, chunk);
+    };
+
+    const int index = GetChunkIndex(chunk.position);
+    std::vector<unsigned char> payload;
+    const bool loaded = mappedReads ? region->Read(index, decode) : region->Read(index, payload) && decode(payload.data(), payload.size());
+    if (!loaded)
+        return false;
+
+    std::lock_guard lock(mutex);
+    stats.loads++;
+    stats.bytesRead += payloadBytes;
+    return true;
+}
+
+std::vector<Vector3> RegionStore::ListSaved()
+{
+    std::vector<Vector3> saved;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+    {
+        // Only names GetRegionPath would give, anything else in the directory isn't a region file
+        const std::string name = entry.path().filename().string();
+        int x = 0, y = 0, z = 0;
+        if (std::sscanf(name.c_str(), "r.%d.%d.%d.region", &x, &y, &z) != 3)
+            continue;
+        const Vector3 regionPos {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+        if (GetRegionPath(regionPos).filename() != entry.path().filename())
+            continue;
+
+        const Vector3 firstChunk = Vector3Scale(regionPos, RegionFile::chunksPerAxis);
+        const RegionFile* region = GetRegion(firstChunk, false);
+        if (region == nullptr || !region->IsOpen())
+            continue;
+
+        for (int cx = 0; cx < RegionFile::chunksPerAxis; cx++)
+            for (int cy = 0; cy < RegionFile::chunksPerAxis; cy++)
+                for (int cz = 0; cz < RegionFile::chunksPerAxis; cz++)
+                    if (region->Has(RegionFile::GetChunkIndex(cx, cy, cz)))
+                        saved.push_back(Vector3Add(firstChunk, Vector3{static_cast<float>(cx), static_cast<float>(cy), static_cast<float>(cz)}));
+    }
+
+    return saved;
+}
+
+bool RegionStore::Save(const Chunk& chunk)
+{
+    RegionFile* region = GetRegion(chunk.position, true);
+    const std::vector<unsigned char> payload = ChunkCodec::Encode(chunk);
+    const bool saved = region->Write(GetChunkIndex(chunk.position), payload) && region->Flush();
+    CountSave(payload.size(), saved);
+
+    return saved;
+}
+
+int RegionStore::SaveBatch(std::vector<PendingSave> batch)
+{
+    // Grouped by region, in file order within one
+    const auto order = [](const PendingSave& save)
+    {
+        return std::make_pair(GetGridKey(GetRegionPosition(save.chunkPos)), GetChunkIndex(save.chunkPos));
+    };
+    std::ranges::sort(batch, {}, order);
+
+    int failed = 0;
+    std::vector<bool> written(batch.size());
+    for (size_t first = 0, last = 0; first < batch.size(); first = last)
+    {
+        RegionFile* region = GetRegion(batch[first].chunkPos, true);
+        for (last = first; last < batch.size() && order(batch[last]).first == order(batch[first]).first; last++)
+            written[last] = region->Write(GetChunkIndex(batch[last].chunkPos), *batch[last].payload);
+
+        // A failed flush loses the whole group
+        const bool flushed = region->Flush();
+        for (size_t i = first; i < last; i++)
+        {
+            CountSave(batch[i].payload->size(), written[i] && flushed);
+            failed += written[i] && flushed ? 0 : 1;
+        }
+    }
+
+    return failed;
+}
+
+void RegionStore::CountSave(const size_t payloadBytes, const bool saved)
+{
+    std::lock_guard lock(mutex);
+    if (saved)
+    {
+        stats.saves++;
+        stats.bytesWritten += payloadBytes;
+    }
+    else
+    {
+        stats.failedSaves++;
+    }
+}
+
+void RegionStore::Prefetch(const Vector3 chunkPos)
+{
+    if (RegionFile* region = GetRegion(chunkPos, false); region != nullptr)
+        region->Prefetch(GetChunkIndex(chunkPos));
+}
+
+void RegionStore::SetMappedReads(const bool enabled)
+{
+    mappedReads = enabled;
+}
+
+RegionStore::Stats RegionStore::GetStats() const
+{
+    std::lock_guard lock(mutex);
+
+    Stats result = stats;
+    for (const auto& [key, region] : regions)
+    {
+        if (region == nullptr)
+            continue;
+
+        result.regions++;
+        result.fileBytes += region->GetStats().sectors * RegionFile::sectorBytes;
+    }
+
+    return result;
+}
+
+Vector3 RegionStore::GetRegionPosition(const Vector3 chunkPos)
+{
+    constexpr auto size = static_cast<float>(RegionFile::chunksPerAxis);
+    return Vector3{std::floor(chunkPos.x / size), std::floor(chunkPos.y / size), std::floor(chunkPos.z / size)};
+}
+
+int RegionStore::GetChunkIndex(const Vector3 chunkPos)
+{
+    // Position inside the region, also for negative chunk coordinates
+    const auto local = [](const float coordinate)
+    {
+        return (static_cast<int>(coordinate) % RegionFile::chunksPerAxis + RegionFile::chunksPerAxis) % RegionFile::chunksPerAxis;
+    };
+
+    return RegionFile::GetChunkIndex(local(chunkPos.x), local(chunkPos.y), local(chunkPos.z));
+}
+
+std::filesystem::path RegionStore::GetRegionPath(const Vector3 regionPos) const
+{
+    return directory / ("r." + std::to_string(static_cast<int>(regionPos.x)) + "." + std::to_string(static_cast<int>(regionPos.y)) + "." +
+                        std::to_string(static_cast<int>(regionPos.z)) + ".region");
+}
+
+RegionFile* RegionStore::GetRegion(const Vector3 chunkPos, const bool create)
+{
+    const Vector3 regionPos = GetRegionPosition(chunkPos);
+    const uint64_t key = GetGridKey(regionPos);
+
+    // Regions are never closed, so the file outlives the lock
+    std::lock_guard lock(mutex);
+    if (const auto it = regions.find(key); it != regions.end() && (it->second != nullptr || !create))
+        return it->second.get();
+
+    const std::filesystem::path path = GetRegionPath(regionPos);
+    if (!create && !std::filesystem::exists(path))
+    {
+        regions[key] = nullptr;
+        return nullptr;
+    }
+
+    // Files that fail to open stay in the map too, so they are only complained about once
+    auto& region = regions[key];
+    region = std::make_unique<RegionFile>(path);
+    return region.get();
+}
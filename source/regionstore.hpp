@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hopscotch_map.h"
+#include "chunk.hpp"
+#include "regionfile.hpp"
+
+// Saved chunks of one world: a directory of region files, opened as chunks in them are first asked for
+class RegionStore
+{
+    public:
+        struct Stats
+        {
+            unsigned long loads = 0, saves = 0, failedSaves = 0;
+            size_t bytesRead = 0, bytesWritten = 0; // Chunk payloads
+            size_t regions = 0, fileBytes = 0;      // Region files opened so far
+        };
+
+        explicit RegionStore(std::filesystem::path directory);
+
+        // The seed the world was first generated with, or fallback for a new world, which is then kept
+        uint64_t LoadSeed(uint64_t fallback);
+
+        // An encoded chunk waiting to be written
+        struct PendingSave
+        {
+            Vector3 chunkPos;
+            std::shared_ptr<const std::vector<unsigned char>> payload;
+        };
+
+        // Every chunk saved in the region files of the directory. Opens all of them, so it is meant to run once, off the main thread.
+        [[nodiscard]] std::vector<Vector3> ListSaved();
+        // Any thread. Load fills in the chunk's block data and returns false if it was never saved.
+        bool Load(Chunk& chunk);
+        bool Save(const Chunk& chunk);
+        // Writes one region file after the other and flushes each once its part of the batch is written; returns how many failed
+        int SaveBatch(std::vector<PendingSave> batch);
+        // Starts reading a saved chunk in from disk, so a Load soon after doesn't have to wait for it
+        void Prefetch(Vector3 chunkPos);
+        // Whether Load decodes payloads straight from the mapped region files, or copies them out with buffered reads first.
+        // Only the latter is slower, it is kept as the baseline for benchmarks.
+        void SetMappedReads(bool enabled);
+
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        std::filesystem::path directory;
+        std::atomic<bool> mappedReads = true;
+
+        // Regions without a file on disk map to nullptr until something is saved in them
+        tsl::hopscotch_map<uint64_t, std::unique_ptr<RegionFile>> regions;
+        Stats stats;
+        mutable std::mutex mutex;
+
+        [[nodiscard]] static Vector3 GetRegionPosition(Vector3 chunkPos);
+        [[nodiscard]] static int GetChunkIndex(Vector3 chunkPos);
+        [[nodiscard]] std::filesystem::path GetRegionPath(Vector3 regionPos) const;
+        RegionFile* GetRegion(Vector3 chunkPos, bool create);
+        void CountSave(size_t payloadBytes, bool saved);
+};
@@ -0,0 +1,130 @@
+#include "terraingenerator.hpp"
+
+TerrainGenerator::TerrainGenerator(const siv::PerlinNoise::seed_type seed) : seed(seed)
+{}
+
+siv::PerlinNoise::seed_type TerrainGenerator::GetSeed() const
+{
+    return seed;
+}
+
+int TerrainGenerator::GetTerrainHeight(const int x, const int z) const
+{
+    return static_cast<int>(perlin.octave2D_01(x * 0.0075, z * 0.0075, 4) * 64) + 200;
+}
+
+uint64_t TerrainGenerator::GetBlockHash(const int x, const int y, const int z) const
+{
+    // splitmix64 finalizer over the seed and the packed coordinates
+    uint64_t hash = seed ^ (static_cast<uint64_t>(static_cast<uint32_t>(x)) * 0x9E3779B97F4A7C15ull) ^
+                    (static_cast<uint64_t>(static_cast<uint32_t>(y)) * 0xC2B2AE3D27D4EB4Full) ^ (static_cast<uint64_t>(static_cast<uint32_t>(z)) * 0x165667B19E3779F9ull);
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+void TerrainGenerator::Generate(Chunk& chunk) const
+{
+    // First pass; depth and basic block placing
+    for (int x = 0; x < CHUNK_WIDTH; x++)
+    {
+        for (int y = 0; y < CHUNK_HEIGHT; y++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                Vector3 chunkGlobalPos = chunk.LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+                const int noise = GetTerrainHeight(static_cast<int>(chunkGlobalPos.x), static_cast<int>(chunkGlobalPos.z));
+
+                if (chunkGlobalPos.y > noise)
+                {
+                    chunk.data[x][y][z] = 0;
+                }
+                else if (chunkGlobalPos.y > noise - 1)
+                {
+                    chunk.data[x][y][z] = 1;
+                }
+                else if (chunkGlobalPos.y > noise - 5)
+                {
+                    chunk.data[x][y][z] = 2;
+                }
+                else
+                {
+                    chunk.data[x][y][z] = 4;
+                }
+            }
+        }
+    }
+
+    // Second pass; cave generation
+    for (int x = 0; x < CHUNK_WIDTH; x++)
+    {
+        for (int y = 0; y < CHUNK_HEIGHT; y++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                Vector3 chunkGlobalPos = chunk.LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+                const float noise = perlin.octave3D((chunkGlobalPos.x * 0.025), (chunkGlobalPos.y * 0.025), (chunkGlobalPos.z * 0.025), 4) * (1.85 - (0.005 * chunkGlobalPos.y));
+
+                if (noise > 0.85f)
+                    chunk.data[x][y][z] = 0;
+            }
+        }
+    }
+
+    // Third pass; ore generation
+    for (int x = 0; x < CHUNK_WIDTH; x++)
+    {
+        for (int y = 0; y < CHUNK_HEIGHT; y++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                if (chunk.data[x][y][z] == 4)
+                {
+                    Vector3 chunkGlobalPos = chunk.LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+
+                    // Dirt
+                    float noise = perlin.noise3D((chunkGlobalPos.x * 0.075), (chunkGlobalPos.y * 0.075), (chunkGlobalPos.z * 0.075)) * (0.2 + (0.005 * chunkGlobalPos.y));
+                    if (noise > 0.6f)
+                        chunk.data[x][y][z] = 2;
+
+                    // Gravel
+                    noise = perlin.noise3D((1000 + chunkGlobalPos.x * 0.075), (2500 + chunkGlobalPos.y * 0.075), (4215 + chunkGlobalPos.z * 0.075)) * (1.5 - (0.0025 * chunkGlobalPos.y));
+                    if (noise > 0.65f)
+                        chunk.data[x][y][z] = 8;
+
+                    // Isaac ore
+                    noise = perlin.noise3D((3000 + chunkGlobalPos.x * 0.25), (-2000 + chunkGlobalPos.y * 0.25), (-5201 + chunkGlobalPos.z * 0.25)) * (1.5 - (0.0025 * chunkGlobalPos.y));
+                    if (noise > 0.85f)
+                        chunk.data[x][y][z] = 11;
+
+                    // Diamond ore
+                    noise = perlin.noise3D((-150 + chunkGlobalPos.x * 0.25), (-8400 + chunkGlobalPos.y * 0.25), (-10000 + chunkGlobalPos.z * 0.25)) * (1.1 - (0.0025 * chunkGlobalPos.y));
+                    if (noise > 0.725f)
+                        chunk.data[x][y][z] = 13;
+                }
+            }
+        }
+    }
+
+    // Fourth pass; decals
+    for (int x = 0; x < CHUNK_WIDTH; x++)
+    {
+        for (int y = 0; y < CHUNK_HEIGHT; y++)
+        {
+            for (int z = 0; z < CHUNK_WIDTH; z++)
+            {
+                Vector3 chunkGlobalPos = chunk.LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+                const int noise = GetTerrainHeight(static_cast<int>(chunkGlobalPos.x), static_cast<int>(chunkGlobalPos.z));
+                if (static_cast<int>(chunkGlobalPos.y) - 1 == noise)
+                {
+                    const int randomVal = static_cast<int>(GetBlockHash(static_cast<int>(chunkGlobalPos.x), static_cast<int>(chunkGlobalPos.y),
+                                                                        static_cast<int>(chunkGlobalPos.z)) % 101);
+                    if (randomVal < 15)
+                        chunk.data[x][y][z] = 3;
+                    else if (randomVal < 17)
+                        chunk.data[x][y][z] = 10;
+                }
+            }
+        }
+    }
+}
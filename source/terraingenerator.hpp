@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include "chunk.hpp"
+#include "PerlinNoise.hpp"
+
+// Fills chunks with the world's terrain. Only depends on the seed, decals included, so it runs without a world, e.g. in
+// benchmarks, and a chunk generated again comes out the same.
+class TerrainGenerator
+{
+    public:
+        explicit TerrainGenerator(siv::PerlinNoise::seed_type seed);
+
+        [[nodiscard]] siv::PerlinNoise::seed_type GetSeed() const;
+        // World y of the topmost block placed in a column, before caves are carved out
+        [[nodiscard]] int GetTerrainHeight(int x, int z) const;
+        // Any thread
+        void Generate(Chunk& chunk) const;
+
+    private:
+        const siv::PerlinNoise::seed_type seed;
+        const siv::PerlinNoise perlin{ seed };
+
+        // Stands in for a random roll at one block, the same for every call with the same seed
+        [[nodiscard]] uint64_t GetBlockHash(int x, int y, int z) const;
+};
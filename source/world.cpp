@@ -1,85 +1,282 @@
 #include "world.hpp"
 
+#include <chrono>
+
+#include "backend.hpp"
 #include "blocktype.hpp"
 #include "raymath.h"
+#include "rlgl.h"
+#include "tileatlas.hpp"
 
-World::World(Camera *player) : music(loader.GetMusic("boss.mp3")), playerPos(&player->position)
+World::World(const Vector3 playerPosition, std::filesystem::path saveDirectory, const int distance) : music(loader.GetMusic("boss.mp3")),
+    regionStore(std::move(saveDirectory)), playerPos(playerPosition), playerLastChunk(GetChunkPositionAt(playerPosition)), renderDistance(distance)
 {
-    SetMusicVolume(music, 0.10f);
-    PlayMusicStream(music);
+    Backend::SetMusicVolume(music, 0.10f);
+    Backend::PlayMusicStream(music);
 
-    auto [x, y, z] = GetChunkPositionAt(*playerPos);
-    minChunkPos = Vector3{x + static_cast<float>(-renderDistance)+1, y + static_cast<float>(-renderDistance)+1, z + static_cast<float>(-renderDistance)+1};
-    maxChunkPos = Vector3{x + static_cast<float>(renderDistance), y + static_cast<float>(renderDistance), z + static_cast<float>(renderDistance)};
-
-    for (int i = 0; i < renderDistance * 2; i++)
-    {
-        chunks.push_back(std::make_shared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<Chunk>>>>>());
-    }
+    SetLoadedRange(playerLastChunk);
 
+    ResetChunkGrid();
     GenerateChunks();
+    PublishSnapshot();
 
-    const Texture2D tex = loader.GetTexture2D("textures/blockmap.png");
-    //GenTextureMipmaps(&tex);
-    SetTextureFilter(tex, TEXTURE_FILTER_POINT);
+    // Mipmapped one tile at a time, so distant terrain samples smaller levels without neighboring tiles bleeding in
+    const Texture2D tex = loader.GetTileAtlas("textures/blockmap.png", BlockType::blockmapWidth, BlockType::blockmapHeight);
 
-    opaqueChunkMat = transparentChunkMat = LoadMaterialDefault();
+    opaqueChunkMat = transparentChunkMat = Backend::LoadMaterialDefault();
     SetMaterialTexture(&opaqueChunkMat, MATERIAL_MAP_ALBEDO, tex);
     SetMaterialTexture(&transparentChunkMat, MATERIAL_MAP_ALBEDO, tex);
 
-    opaqueChunkMat.shader = loader.GetShader("shaders/opaque.fs");
-    transparentChunkMat.shader = loader.GetShader("shaders/opaque.fs");
+    // Every pass gets its own fragment shader, only cutouts pay for discard
+    opaqueChunkMat.shader = loader.GetShader("shaders/chunk.vs", "shaders/opaque.fs");
+    transparentChunkMat.shader = loader.GetShader("shaders/translucent.fs");
+
+    const Shader decalShader = loader.GetShader("shaders/decal.vs", "shaders/cutout.fs");
+
+    // Levels below one texel per tile mix tiles together, the shaders stop short of them
+    const int tileSize = tex.width / static_cast<int>(BlockType::blockmapWidth);
+    const float maxTextureLod = static_cast<float>(TileAtlas::GetTileLevelCount(tileSize, tex.height / static_cast<int>(BlockType::blockmapHeight)) - 1);
+    const Shader farTerrainShader = loader.GetShader("shaders/farterrain.vs", "shaders/farterrain.fs");
+    for (const Shader& shader : {opaqueChunkMat.shader, transparentChunkMat.shader, decalShader, farTerrainShader})
+        Backend::SetShaderValue(shader, Backend::GetShaderLocation(shader, "maxTextureLod"), &maxTextureLod, SHADER_UNIFORM_FLOAT);
+
+    decalRenderer.Load(decalShader, tex);
+
+    // Far terrain is colored like the top of a grass block seen from afar, and needs a far plane beyond its last tiles
+    const BlockModel::Model& grassModel = BlockType::Types[surfaceBlockType].model;
+    const auto grassTop = std::ranges::find(grassModel.faces, BlockModel::Direction::Up, &BlockModel::BlockFace::facingDirection);
+    farTerrain.Load(farTerrainShader, tex, BlockType::TransformTexcoordsToBlockmap(Vector2{0.5f, 0.5f}, grassTop - grassModel.faces.begin(), surfaceBlockType));
+    Backend::SetClipPlanes(RL_CULL_DISTANCE_NEAR, FarTerrain::tileBlocks * (FarTerrain::tileRadius + 2) * 1.5);
 }
 
-World::~World() = default;
+World::~World()
+{
+    SaveLoadedChunks();
+    chunkIo.Flush();
+}
 
-void World::Update()
+void World::Update(const Vector3 playerPosition)
 {
-    UpdateMusicStream(music);
+    Backend::UpdateMusicStream(music);
 
-    static Vector3 playerLastChunk = GetChunkPositionAt(*playerPos);
-    if (const Vector3 playerCurrentChunk = GetChunkPositionAt(*playerPos); playerLastChunk != playerCurrentChunk)
+    playerPos = playerPosition;
+    const Vector3 playerCurrentChunk = GetChunkPositionAt(playerPos);
+    chunkIo.SetPlayerChunk(playerCurrentChunk);
+    if (const int distance = requestedRenderDistance.load(); playerLastChunk != playerCurrentChunk || distance != renderDistance)
     {
-        std::cout << "Regenerating chunks" << std::endl;
-
-        // Remove newly inactive chunks (right now just erasing all chunks)
-        chunks.clear();
-
-        // Insert new chunk groups
-        for (int i = 0; i < renderDistance * 2; i++)
+        // Collect currently loaded chunks
+        std::vector<std::shared_ptr<Chunk>> oldChunks;
+        for (const auto &x : chunks)
         {
-            chunks.push_back(std::make_shared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<Chunk>>>>>());
+            for (const auto &y : *x)
+            {
+                for (const auto &z : *y)
+                {
+                    if (z != nullptr)
+                        oldChunks.push_back(z);
+                }
+            }
         }
 
         // Reset position values for generation
         playerLastChunk = playerCurrentChunk;
-        minChunkPos = Vector3{playerLastChunk.x + static_cast<float>(-renderDistance)+1, playerLastChunk.y + static_cast<float>(-renderDistance)+1, playerLastChunk.z + static_cast<float>(-renderDistance)+1};
-        maxChunkPos = Vector3{playerLastChunk.x + static_cast<float>(renderDistance), playerLastChunk.y + static_cast<float>(renderDistance), playerLastChunk.z + static_cast<float>(renderDistance)};
+        renderDistance = distance;
+        SetLoadedRange(playerLastChunk);
+
+        // Keep chunks that are still in range, hand the rest over to the cache
+        ResetChunkGrid();
+        for (const auto &chunk : oldChunks)
+        {
+            const auto [x, y, z] = chunk->position;
+            if (x >= minChunkPos.x && y >= minChunkPos.y && z >= minChunkPos.z &&
+                x <= maxChunkPos.x && y <= maxChunkPos.y && z <= maxChunkPos.z)
+            {
+                (*(*chunks[x - minChunkPos.x])[y - minChunkPos.y])[z - minChunkPos.z] = chunk;
+            }
+            else
+            {
+                SaveChunk(*chunk);
+                chunkCache.Store(*chunk);
+            }
+        }
+        oldChunks.clear();
 
         // Generate new chunks
         GenerateChunks();
     }
+
+    ReceiveLoadedChunks();
+
+    // Flush point for edits in chunks that stay loaded
+    if (const auto now = std::chrono::steady_clock::now(); now - lastAutosave >= autosaveInterval)
+    {
+        SaveLoadedChunks();
+        chunkIo.RequestFlush();
+        lastAutosave = now;
+    }
+
+    UpdateUploadedGeometry();
+}
+
+void World::ReceiveLoadedChunks()
+{
+    bool received = false;
+    for (auto& [chunk, loaded] : chunkIo.TakeLoaded())
+    {
+        // Dropped if it left the loaded range meanwhile, the saved copy is still there
+        const auto [x, y, z] = chunk->position;
+        if (x < minChunkPos.x || y < minChunkPos.y || z < minChunkPos.z || x > maxChunkPos.x || y > maxChunkPos.y || z > maxChunkPos.z)
+            continue;
+
+        // A saved copy that can't be read is replaced
+        if (!loaded)
+        {
+            terrain.Generate(*chunk);
+            chunk->unsaved = true;
+        }
+
+        (*(*chunks[x - minChunkPos.x])[y - minChunkPos.y])[z - minChunkPos.z] = chunk;
+        received = true;
+    }
+
+    // The new chunks and their neighbors may be ready for meshing now
+    if (received)
+    {
+        MeshChunks();
+        UpdateHorizonSlabs();
+    }
+}
+
+void World::UpdateUploadedGeometry()
+{
+    const bool freeUploaded = freeUploadedMeshes;
+    for (const auto &x : chunks)
+    {
+        for (const auto &y : *x)
+        {
+            for (const auto &z : *y)
+            {
+                if (z == nullptr || z->mesh == nullptr)
+                    continue;
+
+                // The renderer had to upload a build again whose geometry was already freed
+                if (z->geometryLost.exchange(false))
+                {
+                    z->GenerateChunkMesh(z->lodLevel, z->lodSeams);
+                    continue;
+                }
+
+                if (freeUploaded)
+                    z->FreeUploadedGeometry();
+            }
+        }
+    }
+}
+
+void World::SetLoadedRange(const Vector3 centerChunk)
+{
+    // Block data is loaded one halo ring beyond the meshed range, so border chunks have all their neighbors
+    const auto lower = static_cast<float>(-renderDistance + 1 - haloSize);
+    const auto upper = static_cast<float>(renderDistance + haloSize);
+    const auto lowerY = static_cast<float>(-verticalRenderDistance + 1 - haloSize);
+    const auto upperY = static_cast<float>(verticalRenderDistance + haloSize);
+    minChunkPos = Vector3{centerChunk.x + lower, centerChunk.y + lowerY, centerChunk.z + lower};
+    maxChunkPos = Vector3{centerChunk.x + upper, centerChunk.y + upperY, centerChunk.z + upper};
+}
+
+void World::ResetChunkGrid()
+{
+    // Fill the loaded range with empty slots
+    const int size = (renderDistance + haloSize) * 2;
+    const int sizeY = (verticalRenderDistance + haloSize) * 2;
+    chunks.clear();
+    for (int x = 0; x < size; x++)
+    {
+        auto slice = std::make_shared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<Chunk>>>>>();
+        for (int y = 0; y < sizeY; y++)
+        {
+            slice->push_back(std::make_shared<std::vector<std::shared_ptr<Chunk>>>(size));
+        }
+        chunks.push_back(slice);
+    }
+}
+
+bool World::IsInMeshRange(const Vector3 chunkPos) const
+{
+    return chunkPos.x >= minChunkPos.x + haloSize && chunkPos.y >= minChunkPos.y + haloSize && chunkPos.z >= minChunkPos.z + haloSize &&
+           chunkPos.x <= maxChunkPos.x - haloSize && chunkPos.y <= maxChunkPos.y - haloSize && chunkPos.z <= maxChunkPos.z - haloSize;
+}
+
+int World::GetNeighborMask(const Vector3 chunkPos) const
+{
+    // Bitmask of the six face neighbors that hold block data, using the BlockModel::Direction bits
+    int result = 0;
+    for (int i = 0; i < BlockModel::DirectionCount; i++)
+    {
+        const auto direction = static_cast<BlockModel::Direction>(1 << i);
+        const auto [x, y, z] = BlockModel::DirectionToOffset(direction);
+        if (GetChunkAt(Vector3{chunkPos.x + x, chunkPos.y + y, chunkPos.z + z}) != nullptr)
+            result |= static_cast<int>(direction);
+    }
+
+    return result;
+}
+
+int World::GetLodSeams(const Vector3 chunkPos, const int lodLevel) const
+{
+    // Horizontal face neighbors meshed at another level of detail, using the BlockModel::Direction bits.
+    // The surface runs horizontally, so only the vertical borders between chunk columns open up cracks.
+    int result = 0;
+    for (const BlockModel::Direction direction : {BlockModel::Direction::Forward, BlockModel::Direction::Backward, BlockModel::Direction::Left, BlockModel::Direction::Right})
+    {
+        const auto [x, y, z] = BlockModel::DirectionToOffset(direction);
+        const Vector3 neighbor = {chunkPos.x + x, chunkPos.y + y, chunkPos.z + z};
+        if (IsInMeshRange(neighbor) && GetLodLevelAt(neighbor) != lodLevel)
+            result |= static_cast<int>(direction);
+    }
+
+    return result;
 }
 
 void World::GenerateChunks()
 {
-    // Generate chunks
+    // Fill empty slots, from the cache when possible. Saved chunks are left to the I/O thread and fill their slots in a later tick.
+    // Workers take x slices of the loaded range until none are left.
+    const int sliceCount = static_cast<int>(maxChunkPos.x - minChunkPos.x) + 1;
+    std::atomic<int> nextSlice = 0;
     std::vector<std::thread> chunkGenThreads;
-    for (int x = minChunkPos.x; x <= maxChunkPos.x; x++)
+    for (int worker = 0; worker < std::clamp(workerCount.load(), 1, sliceCount); worker++)
     {
-        auto chunkGenThread = std::thread([x, this]()
+        auto chunkGenThread = std::thread([&nextSlice, sliceCount, this]()
         {
-            for (int y = minChunkPos.y; y <= maxChunkPos.y; y++)
+            for (int slice = nextSlice++; slice < sliceCount; slice = nextSlice++)
             {
-                auto row = std::make_shared<std::vector<std::shared_ptr<Chunk>>>();
-                for (int z = minChunkPos.z; z <= maxChunkPos.z; z++)
+                const int x = static_cast<int>(minChunkPos.x) + slice;
+                for (int y = minChunkPos.y; y <= maxChunkPos.y; y++)
                 {
-                    const Vector3 chunkPos {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
-                    auto newChunk = GenerateChunk(chunkPos);
-                    row->push_back(newChunk);
+                    auto &row = *(*chunks[x-minChunkPos.x])[y-minChunkPos.y];
+                    for (int z = minChunkPos.z; z <= maxChunkPos.z; z++)
+                    {
+                        auto &slot = row[z-minChunkPos.z];
+                        const Vector3 chunkPos {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+                        if (slot != nullptr || chunkIo.IsLoading(chunkPos))
+                            continue;
+
+                        auto newChunk = std::make_shared<Chunk>(this, chunkPos);
+                        if (!chunkCache.Restore(*newChunk))
+                        {
+                            if (chunkIo.IsSaved(chunkPos))
+                            {
+                                chunkIo.Load(newChunk);
+                                continue;
+                            }
+
+                            terrain.Generate(*newChunk);
+                            newChunk->unsaved = true;
+                        }
+                        slot = newChunk;
+                    }
                 }
-
-                chunks[x-minChunkPos.x]->push_back(row);
             }
         });
         chunkGenThreads.push_back(std::move(chunkGenThread));
@@ -91,25 +288,49 @@ void World::GenerateChunks()
         thread.join();
     }
 
-    // Generate chunk meshes
+    MeshChunks();
+    UpdateHorizonSlabs();
+}
+
+void World::MeshChunks()
+{
+    // Generate chunk meshes inside the meshed range. A chunk is only meshed once all six neighbors hold data,
+    // and is meshed again if it was built before they all arrived or at another level of detail.
     for (const auto &x : chunks)
     {
         for (const auto &y : *x)
         {
             for (const auto &z : *y)
             {
-                z->GenerateChunkMesh();
+                if (z == nullptr || !IsInMeshRange(z->position))
+                    continue;
+
+                const int neighborMask = GetNeighborMask(z->position);
+                if (neighborMask != allNeighborsMask)
+                    continue;
+
+                const int lodLevel = GetLodLevelAt(z->position);
+                const int lodSeams = GetLodSeams(z->position, lodLevel);
+                if (z->mesh == nullptr || z->meshNeighborMask != neighborMask || z->lodLevel != lodLevel || z->lodSeams != lodSeams)
+                {
+                    z->GenerateChunkMesh(lodLevel, lodSeams);
+                    z->meshNeighborMask = neighborMask;
+                }
             }
         }
     }
 }
 
-void World::RenderChunks() const
+void World::SaveChunk(Chunk& chunk)
 {
-    // Sort chunks based on distance
-    // TODO: Cache result and only update when player crosses chunk boundary
-    std::vector<std::shared_ptr<Chunk>> sortedChunks;
+    // Written by the I/O thread at the next flush point. A failed save is only counted, the chunk is generated again on a later visit.
+    if (chunk.unsaved)
+        chunkIo.Save(chunk);
+    chunk.unsaved = false;
+}
 
+void World::SaveLoadedChunks()
+{
     for (const auto &x : chunks)
     {
         for (const auto &y : *x)
@@ -117,40 +338,309 @@ void World::RenderChunks() const
             for (const auto &z : *y)
             {
                 if (z != nullptr)
-                    sortedChunks.push_back(z);
+                    SaveChunk(*z);
             }
         }
     }
+}
+
+void World::UpdateHorizonSlabs()
+{
+    const int size = renderDistance * 2;
+    horizonCuller.Reset(static_cast<int>(minChunkPos.x) + haloSize, static_cast<int>(minChunkPos.z) + haloSize, size, size);
+    for (int x = minChunkPos.x + haloSize; x <= maxChunkPos.x - haloSize; x++)
+    {
+        for (int z = minChunkPos.z + haloSize; z <= maxChunkPos.z - haloSize; z++)
+            UpdateHorizonSlab(x, z);
+    }
+}
 
-    Vector3 pos = *playerPos;
-    std::ranges::sort(sortedChunks, [pos](std::shared_ptr<Chunk> a, std::shared_ptr<Chunk> b)
+void World::UpdateHorizonSlab(const int x, const int z)
+{
+    // Only meshed chunks have column summaries
+    std::vector<const Chunk*> column;
+    for (int y = maxChunkPos.y - haloSize; y >= minChunkPos.y + haloSize; y--)
     {
-        return Vector3DistanceSqr(pos, a->worldPosition) < Vector3DistanceSqr(pos, b->worldPosition);
+        const std::shared_ptr<Chunk> chunk = GetChunkAt(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+        column.push_back(chunk != nullptr && chunk->mesh != nullptr ? chunk.get() : nullptr);
+    }
+
+    horizonCuller.SetSlab(x, z, HorizonCuller::ComputeSlab(column));
+}
+
+void World::PublishSnapshot()
+{
+    auto next = std::make_shared<RenderSnapshot>();
+    next->minChunkPos = Vector3AddValue(minChunkPos, static_cast<float>(haloSize));
+    next->maxChunkPos = Vector3SubtractValue(maxChunkPos, static_cast<float>(haloSize));
+    next->horizonCuller = horizonCuller;
+
+    // Halo chunks only exist for their neighbors' sake
+    const int size = renderDistance * 2, sizeY = verticalRenderDistance * 2;
+    next->grid.assign(size * sizeY * size, -1);
+    for (const auto &x : chunks)
+    {
+        for (const auto &y : *x)
+        {
+            for (const auto &z : *y)
+            {
+                if (z == nullptr || z->mesh == nullptr || !IsInMeshRange(z->position))
+                    continue;
+
+                const Vector3 offset = Vector3Subtract(z->position, next->minChunkPos);
+                next->grid[(static_cast<int>(offset.x) * sizeY + static_cast<int>(offset.y)) * size + static_cast<int>(offset.z)] = static_cast<int>(next->entries.size());
+                next->entries.push_back({z, z->mesh});
+            }
+        }
+    }
+
+    // The previous snapshot lives on until the render thread lets go of it
+    std::lock_guard lock(snapshotMutex);
+    snapshot = std::move(next);
+}
+
+const RenderSnapshot::Entry* RenderSnapshot::GetEntryAt(const Vector3 chunkPos) const
+{
+    const Vector3 offset = Vector3Subtract(chunkPos, minChunkPos);
+    const auto [sizeX, sizeY, sizeZ] = Vector3AddValue(Vector3Subtract(maxChunkPos, minChunkPos), 1);
+    if (offset.x < 0 || offset.y < 0 || offset.z < 0 || offset.x >= sizeX || offset.y >= sizeY || offset.z >= sizeZ)
+        return nullptr;
+
+    const int index = grid[(static_cast<int>(offset.x) * static_cast<int>(sizeY) + static_cast<int>(offset.y)) * static_cast<int>(sizeZ) + static_cast<int>(offset.z)];
+    return index >= 0 ? &entries[index] : nullptr;
+}
+
+void World::RenderChunks(const Camera& camera) const
+{
+    // Hold on to the latest tick's snapshot for the whole frame, the simulation may publish the next one meanwhile
+    std::shared_ptr<const RenderSnapshot> frame;
+    {
+        std::lock_guard lock(snapshotMutex);
+        frame = snapshot;
+    }
+
+    // Sort chunks based on distance
+    // TODO: Cache result and only update when player crosses chunk boundary
+    std::vector<const RenderSnapshot::Entry*> sortedChunks;
+    for (const auto& entry : frame->entries)
+        sortedChunks.push_back(&entry);
+
+    const Vector3 pos = camera.position;
+    std::ranges::sort(sortedChunks, [pos](const RenderSnapshot::Entry* a, const RenderSnapshot::Entry* b)
+    {
+        return Vector3DistanceSqr(pos, a->chunk->worldPosition) < Vector3DistanceSqr(pos, b->chunk->worldPosition);
     });
 
-    // Render opaques front to back
-    for (const auto &chunk : sortedChunks)
+    // Skip chunks that are sealed off from the camera, e.g. everything around a cave except the cave itself
+    const auto visibleChunks = FindVisibleChunks(*frame, camera);
+
+    // Skip chunks buried below the terrain when looking at it from above
+    HorizonCuller horizonCuller = frame->horizonCuller;
+    horizonCuller.SetCamera(pos);
+
+    const auto isVisible = [&](const Chunk* chunk)
+    {
+        return (!visibleChunks || visibleChunks->contains(chunk)) && !horizonCuller.IsHidden(chunk->position);
+    };
+
+    // GPU resources of chunks dropped since the last frame
+    releaseQueue.Flush();
+
+    // Upload new meshes nearest first, within a per-frame byte and time budget so streaming doesn't cause spikes.
+    // Chunks keep drawing their previous upload meanwhile. If the arena has to grow, everything in it is copied along,
+    // except where the backend can't copy buffers. Then it all has to go up again, so start over from the nearest chunk;
+    // the budget still holds and the rest follows in later frames.
+    const auto uploadStart = std::chrono::steady_clock::now();
+    size_t uploadedBytes = 0;
+    for (int i = 0; i < sortedChunks.size(); i++)
     {
-        if (chunk->reuploadMeshFlag)
-            chunk->UploadChunkMesh();
-        if (chunk->validMesh)
+        const auto& [chunk, mesh] = *sortedChunks[i];
+        if (!chunk->NeedsUpload(mesh, opaqueArena))
+            continue;
+
+        // Geometry freed after an earlier upload, before the arena grew without copying. It stays undrawn until the simulation builds it again.
+        if (!mesh->HasGeometry())
         {
-            auto [x, y, z] = chunk->worldPosition;
-            DrawMesh(chunk->opaqueMesh, opaqueChunkMat, MatrixTranslate(x, y, z));
+            chunk->geometryLost = true;
+            continue;
         }
+
+        // Always upload at least one mesh, so nothing starves
+        const size_t byteSize = chunk->GetUploadByteSize(*mesh);
+        const double elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+        if (uploadedBytes > 0 && (uploadedBytes + byteSize > uploadBytesPerFrame || elapsedMilliseconds > uploadMillisecondsPerFrame))
+            break;
+
+        if (!chunk->UploadChunkMesh(gpuContext, mesh))
+        {
+            opaqueArena.Grow();
+            i = -1;
+            continue;
+        }
+        uploadedBytes += byteSize;
     }
 
-    // Render transparents back to front
+    pendingUploads = 0;
+    for (const auto* entry : sortedChunks)
+        pendingUploads += entry->chunk->NeedsUpload(entry->mesh, opaqueArena);
+
+    // Render opaques front to back, all out of the shared arena in one multi-draw with only the face directions that can face the camera
+    opaqueArena.Begin(opaqueChunkMat);
+    for (const auto* entry : sortedChunks)
+    {
+        const Chunk* chunk = entry->chunk.get();
+        if (chunk->uploadedMesh != nullptr && chunk->opaqueAllocation.vertexCount > 0 && isVisible(chunk))
+            opaqueArena.Draw(chunk->opaqueAllocation, chunk->GetVisibleOpaqueRanges(pos));
+    }
+    opaqueArena.End();
+
+    // Render cutout decals instanced, they write depth like opaques so order doesn't matter
+    decalRenderer.Begin();
+    for (const auto* entry : sortedChunks)
+    {
+        // Cheap distance cull against the chunk's bounding sphere
+        const Chunk* chunk = entry->chunk.get();
+        const Vector3 center = Vector3Add(chunk->worldPosition, Vector3{CHUNK_WIDTH / 2.0f, CHUNK_HEIGHT / 2.0f, CHUNK_WIDTH / 2.0f});
+        const float radius = Vector3Length(Vector3{CHUNK_WIDTH / 2.0f, CHUNK_HEIGHT / 2.0f, CHUNK_WIDTH / 2.0f});
+        if (chunk->uploadedMesh != nullptr && Vector3Distance(pos, center) - radius <= decalDrawDistance && isVisible(chunk))
+            decalRenderer.Draw(chunk->decals, chunk->worldPosition);
+    }
+    decalRenderer.End();
+
+    // Heightmap terrain out to the horizon, everywhere outside the box of meshed chunks
+    const Vector3 realMin = {frame->minChunkPos.x * CHUNK_WIDTH, frame->minChunkPos.y * CHUNK_HEIGHT, frame->minChunkPos.z * CHUNK_WIDTH};
+    const Vector3 realMax = {(frame->maxChunkPos.x + 1) * CHUNK_WIDTH, (frame->maxChunkPos.y + 1) * CHUNK_HEIGHT, (frame->maxChunkPos.z + 1) * CHUNK_WIDTH};
+    farTerrain.Draw(pos, BoundingBox{realMin, realMax});
+
+    // Render translucents back to front
     for (int i = sortedChunks.size() - 1; i >= 0; i--)
     {
-        if (sortedChunks[i]->validMesh)
+        const Chunk* chunk = sortedChunks[i]->chunk.get();
+        if (chunk->uploadedMesh != nullptr && chunk->transparentGpuMesh.vertexCount > 0 && isVisible(chunk))
         {
-            auto [x, y, z] = sortedChunks[i]->worldPosition;
-            DrawMesh(sortedChunks[i]->transparentMesh, transparentChunkMat, MatrixTranslate(x, y, z));
+            auto [x, y, z] = chunk->worldPosition;
+            Backend::DrawMesh(chunk->transparentGpuMesh, transparentChunkMat, MatrixTranslate(x, y, z));
         }
     }
 }
 
+void World::SetUploadBudget(const size_t bytesPerFrame)
+{
+    uploadBytesPerFrame = bytesPerFrame;
+}
+
+size_t World::GetUploadBudget() const
+{
+    return uploadBytesPerFrame;
+}
+
+int World::GetPendingUploads() const
+{
+    return pendingUploads;
+}
+
+size_t World::GetArenaBytes() const
+{
+    return static_cast<size_t>(opaqueArena.GetAllocator().GetUsed()) * (8 * sizeof(float) + 4 * sizeof(unsigned char));
+}
+
+void World::SetRenderDistance(const int distance)
+{
+    requestedRenderDistance = distance;
+}
+
+int World::GetRenderDistance() const
+{
+    return requestedRenderDistance;
+}
+
+void World::SetWorkerCount(const int count)
+{
+    workerCount = count;
+}
+
+int World::GetWorkerCount() const
+{
+    return workerCount;
+}
+
+void World::SetFreeUploadedMeshes(const bool enabled)
+{
+    freeUploadedMeshes = enabled;
+}
+
+bool World::GetFreeUploadedMeshes() const
+{
+    return freeUploadedMeshes;
+}
+
+size_t World::GetCpuMeshBytes()
+{
+    return CpuMesh::residentBytes;
+}
+
+ChunkIo::Stats World::GetIoStats() const
+{
+    return chunkIo.GetStats();
+}
+
+ChunkCache::Stats World::GetCacheStats() const
+{
+    return chunkCache.GetStats();
+}
+
+std::optional<tsl::hopscotch_set<const Chunk*>> World::FindVisibleChunks(const RenderSnapshot& frame, const Camera& camera)
+{
+    // Without a chunk to start from, everything counts as visible
+    const RenderSnapshot::Entry* start = frame.GetEntryAt(GetChunkPositionAt(camera.position));
+    if (start == nullptr)
+        return std::nullopt;
+
+    const Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    const Vector3 halfChunk = {CHUNK_WIDTH / 2.0f, CHUNK_HEIGHT / 2.0f, CHUNK_WIDTH / 2.0f};
+    const float chunkRadius = Vector3Length(halfChunk);
+
+    struct Step
+    {
+        const RenderSnapshot::Entry* entry;
+        int enteredFrom;   // Direction index of the face the walk came in through, -1 for the camera's chunk
+        int directions;    // Every direction the walk went so far
+    };
+
+    // Breadth-first walk from the camera's chunk. It only leaves a chunk through faces connected to the one it came in through,
+    // never heads back against a direction it already went, and stays in front of the camera.
+    tsl::hopscotch_set<const Chunk*> visible;
+    std::vector<Step> queue = {{start, -1, 0}};
+    visible.insert(start->chunk.get());
+    for (int i = 0; i < queue.size(); i++)
+    {
+        const auto [entry, enteredFrom, directions] = queue[i];
+        for (int direction = 0; direction < BlockModel::DirectionCount; direction++)
+        {
+            const int opposite = direction ^ 1;
+            if (directions & (1 << opposite))
+                continue;
+            if (enteredFrom >= 0 && !entry->mesh->AreFacesConnected(enteredFrom, direction))
+                continue;
+
+            const auto [dx, dy, dz] = BlockModel::DirectionToOffset(static_cast<BlockModel::Direction>(1 << direction));
+            const Vector3 neighborPos = {entry->chunk->position.x + dx, entry->chunk->position.y + dy, entry->chunk->position.z + dz};
+            const RenderSnapshot::Entry* neighbor = frame.GetEntryAt(neighborPos);
+            if (neighbor == nullptr)
+                continue;
+
+            const Vector3 toCenter = Vector3Subtract(Vector3Add(neighbor->chunk->worldPosition, halfChunk), camera.position);
+            if (Vector3DotProduct(toCenter, forward) < -chunkRadius)
+                continue;
+
+            if (visible.insert(neighbor->chunk.get()).second)
+                queue.push_back({neighbor, opposite, directions | (1 << direction)});
+        }
+    }
+
+    return visible;
+}
+
 unsigned char World::GetBlockAt(const int x, const int y, const int z) const
 {
     const Vector3 chunkIndex = GetChunkPositionAt(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
@@ -160,13 +650,111 @@ unsigned char World::GetBlockAt(const int x, const int y, const int z) const
     if (chunk == nullptr)
         return 0;
 
-    const unsigned int blockIndexX = x % CHUNK_WIDTH;
-    const unsigned int blockIndexY = y % CHUNK_HEIGHT;
-    const unsigned int blockIndexZ = z % CHUNK_WIDTH;
+    // Relative to the chunk's corner, % would go negative below zero
+    const int blockIndexX = x - static_cast<int>(chunk->worldPosition.x);
+    const int blockIndexY = y - static_cast<int>(chunk->worldPosition.y);
+    const int blockIndexZ = z - static_cast<int>(chunk->worldPosition.z);
 
     return chunk->data[blockIndexX][blockIndexY][blockIndexZ];
 }
 
+void World::SetBlockAt(const int x, const int y, const int z, const unsigned char blockType)
+{
+    const std::shared_ptr<Chunk> chunk = GetChunkAt(GetChunkPositionAt(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)}));
+    if (chunk == nullptr)
+        return;
+
+    unsigned char& block = chunk->data[x - static_cast<int>(chunk->worldPosition.x)][y - static_cast<int>(chunk->worldPosition.y)][z - static_cast<int>(chunk->worldPosition.z)];
+    const unsigned char oldBlockType = block;
+    if (oldBlockType == blockType)
+        return;
+    block = blockType;
+    chunk->unsaved = true;
+
+    // Glass lives in the transparent mesh, which can only be rebuilt as a whole
+    const bool transparentChanged = BlockType::GetRenderPass(oldBlockType) == BlockType::RenderPass::Translucent ||
+                                    BlockType::GetRenderPass(blockType) == BlockType::RenderPass::Translucent;
+
+    // The faces and AO of every block around the edit can change, and those may sit in neighboring chunks
+    std::vector<std::shared_ptr<Chunk>> affectedChunks;
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                const Vector3 neighborPos {static_cast<float>(x + dx), static_cast<float>(y + dy), static_cast<float>(z + dz)};
+                const std::shared_ptr<Chunk> neighbor = GetChunkAt(GetChunkPositionAt(neighborPos));
+                if (neighbor != nullptr && IsInMeshRange(neighbor->position) && std::ranges::find(affectedChunks, neighbor) == affectedChunks.end())
+                    affectedChunks.push_back(neighbor);
+            }
+        }
+    }
+
+    // Cached chunks around this one were meshed against its old blocks
+    const Vector3 chunkPos = chunk->position;
+    for (int dx = -1; dx <= 1; dx++)
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dz = -1; dz <= 1; dz++)
+                if (dx != 0 || dy != 0 || dz != 0)
+                    chunkCache.InvalidateMesh(Vector3{chunkPos.x + dx, chunkPos.y + dy, chunkPos.z + dz});
+
+    // Patch the meshes where possible, rebuild the whole mesh otherwise
+    for (const auto& affected : affectedChunks)
+    {
+        if (affected->mesh == nullptr)
+            continue;
+
+        const int localX = x - static_cast<int>(affected->worldPosition.x);
+        const int localY = y - static_cast<int>(affected->worldPosition.y);
+        const int localZ = z - static_cast<int>(affected->worldPosition.z);
+        if ((transparentChanged && affected == chunk) || !affected->PatchBlockFaces(localX, localY, localZ))
+            affected->GenerateChunkMesh(affected->lodLevel, affected->lodSeams);
+    }
+
+    // The edit may have dug through or filled in the solid slab of its chunk column
+    UpdateHorizonSlab(static_cast<int>(chunk->position.x), static_cast<int>(chunk->position.z));
+}
+
+bool World::RaycastBlock(const Vector3 origin, const Vector3 direction, const float maxDistance, std::array<int, 3>& hit, std::array<int, 3>& previous) const
+{
+    // Step through the blocks along the ray one boundary at a time (Amanatides & Woo)
+    std::array<int, 3> block = {static_cast<int>(std::floor(origin.x)), static_cast<int>(std::floor(origin.y)), static_cast<int>(std::floor(origin.z))};
+
+    // Starting inside a block there is no empty block in front of the hit to place into
+    if (GetBlockAt(block[0], block[1], block[2]) != 0)
+        return false;
+
+    const std::array<float, 3> start = {origin.x, origin.y, origin.z};
+    const std::array<float, 3> dir = {direction.x, direction.y, direction.z};
+
+    std::array<int, 3> step {};
+    std::array<float, 3> tMax {}, tDelta {};
+    for (int i = 0; i < 3; i++)
+    {
+        step[i] = dir[i] > 0 ? 1 : -1;
+        tDelta[i] = dir[i] != 0 ? std::abs(1.0f / dir[i]) : INFINITY;
+        const float boundary = dir[i] > 0 ? static_cast<float>(block[i] + 1) : static_cast<float>(block[i]);
+        tMax[i] = dir[i] != 0 ? (boundary - start[i]) / dir[i] : INFINITY;
+    }
+
+    while (true)
+    {
+        previous = block;
+        const int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        block[axis] += step[axis];
+        if (tMax[axis] > maxDistance)
+            return false;
+        tMax[axis] += tDelta[axis];
+
+        if (GetBlockAt(block[0], block[1], block[2]) != 0)
+        {
+            hit = block;
+            return true;
+        }
+    }
+}
+
 Vector3 World::GetChunkPositionAt(const Vector3 in)
 {
     const float chunkIndexX = std::floor(in.x / static_cast<float>(CHUNK_WIDTH));
@@ -198,111 +786,24 @@ bool World::IsBlockAtCoordsTransparent(const int x, const int y, const int z) co
     return BlockType::Types[block].isTransparent;
 }
 
-std::shared_ptr<Chunk> World::GenerateChunk(const Vector3 chunkPos)
+int World::GetLodLevelAt(const Vector3 chunkPos) const
 {
-    auto newChunk = std::make_shared<Chunk>(this, chunkPos);
-
-    // First pass; depth and basic block placing
-    for (int x = 0; x < CHUNK_WIDTH; x++)
-    {
-        for (int y = 0; y < CHUNK_HEIGHT; y++)
-        {
-            for (int z = 0; z < CHUNK_WIDTH; z++)
-            {
-                Vector3 chunkGlobalPos = newChunk->LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-                const int noise = (perlin.octave2D_01((chunkGlobalPos.x * 0.0075), (chunkGlobalPos.z * 0.0075), 4) * 64) + 200;
-
-                if (chunkGlobalPos.y > noise)
-                {
-                    newChunk->data[x][y][z] = 0;
-                }
-                else if (chunkGlobalPos.y > noise - 1)
-                {
-                    newChunk->data[x][y][z] = 1;
-                }
-                else if (chunkGlobalPos.y > noise - 5)
-                {
-                    newChunk->data[x][y][z] = 2;
-                }
-                else
-                {
-                    newChunk->data[x][y][z] = 4;
-                }
-            }
-        }
-    }
+    // LOD rings are measured from the player's chunk, so levels only change when a chunk boundary is crossed.
+    // They scale with the render distance, so every level covers a similar share of the loaded range.
+    const Vector3 playerChunk = GetChunkPositionAt(playerPos);
+    const int distance = static_cast<int>(std::max({std::abs(chunkPos.x - playerChunk.x), std::abs(chunkPos.y - playerChunk.y), std::abs(chunkPos.z - playerChunk.z)}));
 
-    // Second pass; cave generation
-    for (int x = 0; x < CHUNK_WIDTH; x++)
+    int level = 0;
+    for (int i = 0; i < lodDistanceFractions.size(); i++)
     {
-        for (int y = 0; y < CHUNK_HEIGHT; y++)
-        {
-            for (int z = 0; z < CHUNK_WIDTH; z++)
-            {
-                Vector3 chunkGlobalPos = newChunk->LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-                const float noise = perlin.octave3D((chunkGlobalPos.x * 0.025), (chunkGlobalPos.y * 0.025), (chunkGlobalPos.z * 0.025), 4) * (1.85 - (0.005 * chunkGlobalPos.y));
-
-                if (noise > 0.85f)
-                    newChunk->data[x][y][z] = 0;
-            }
-        }
+        if (distance >= std::max(static_cast<int>(std::ceil(renderDistance * lodDistanceFractions[i])), minLodDistance + i))
+            level++;
     }
 
-    // Third pass; ore generation
-    for (int x = 0; x < CHUNK_WIDTH; x++)
-    {
-        for (int y = 0; y < CHUNK_HEIGHT; y++)
-        {
-            for (int z = 0; z < CHUNK_WIDTH; z++)
-            {
-                if (newChunk->data[x][y][z] == 4)
-                {
-                    Vector3 chunkGlobalPos = newChunk->LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-
-                    // Dirt
-                    float noise = perlin.noise3D((chunkGlobalPos.x * 0.075), (chunkGlobalPos.y * 0.075), (chunkGlobalPos.z * 0.075)) * (0.2 + (0.005 * chunkGlobalPos.y));
-                    if (noise > 0.6f)
-                        newChunk->data[x][y][z] = 2;
-
-                    // Gravel
-                    noise = perlin.noise3D((1000 + chunkGlobalPos.x * 0.075), (2500 + chunkGlobalPos.y * 0.075), (4215 + chunkGlobalPos.z * 0.075)) * (1.5 - (0.0025 * chunkGlobalPos.y));
-                    if (noise > 0.65f)
-                        newChunk->data[x][y][z] = 8;
-
-                    // Isaac ore
-                    noise = perlin.noise3D((3000 + chunkGlobalPos.x * 0.25), (-2000 + chunkGlobalPos.y * 0.25), (-5201 + chunkGlobalPos.z * 0.25)) * (1.5 - (0.0025 * chunkGlobalPos.y));
-                    if (noise > 0.85f)
-                        newChunk->data[x][y][z] = 11;
-
-                    // Diamond ore
-                    noise = perlin.noise3D((-150 + chunkGlobalPos.x * 0.25), (-8400 + chunkGlobalPos.y * 0.25), (-10000 + chunkGlobalPos.z * 0.25)) * (1.1 - (0.0025 * chunkGlobalPos.y));
-                    if (noise > 0.725f)
-                        newChunk->data[x][y][z] = 13;
-                }
-            }
-        }
-    }
-
-    // Fourth pass; decals
-    for (int x = 0; x < CHUNK_WIDTH; x++)
-    {
-        for (int y = 0; y < CHUNK_HEIGHT; y++)
-        {
-            for (int z = 0; z < CHUNK_WIDTH; z++)
-            {
-                Vector3 chunkGlobalPos = newChunk->LocalToGlobalPos(Vector3{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-                const int noise = (perlin.octave2D_01((chunkGlobalPos.x * 0.0075), (chunkGlobalPos.z * 0.0075), 4) * 64) + 200;
-                if (static_cast<int>(chunkGlobalPos.y) - 1 == noise)
-                {
-                    int randomVal = GetRandomValue(0, 100);
-                    if (randomVal < 15)
-                        newChunk->data[x][y][z] = 3;
-                    else if (randomVal < 17)
-                        newChunk->data[x][y][z] = 10;
-                }
-            }
-        }
-    }
+    return level;
+}
 
-    return newChunk;
+int World::GetTerrainHeight(const int x, const int z) const
+{
+    return terrain.GetTerrainHeight(x, z);
 }
@@ -1,51 +1,156 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <thread>
 #include <mutex>
 #include <iostream>
 #include <queue>
 #include <memory>
+#include <optional>
 
 #include "chunk.hpp"
+#include "chunkcache.hpp"
+#include "chunkio.hpp"
+#include "decalrenderer.hpp"
+#include "farterrain.hpp"
+#include "hopscotch_set.h"
+#include "horizonculler.hpp"
+#include "regionstore.hpp"
 #include "resourceloader.hpp"
-#include "PerlinNoise.hpp"
+#include "terraingenerator.hpp"
 #include "raymath.h"
 
+// What the renderer draws: the meshed chunks and their builds as of one simulation tick. Immutable once published,
+// later ticks publish a new one instead.
+struct RenderSnapshot
+{
+    struct Entry
+    {
+        std::shared_ptr<Chunk> chunk; // Only its render side is touched while drawing
+        std::shared_ptr<const ChunkMesh> mesh;
+    };
+
+    std::vector<Entry> entries;  // Every chunk of the meshed range that has a mesh
+    Vector3 minChunkPos{}, maxChunkPos{}; // The meshed range
+    std::vector<int> grid;       // Index into entries per chunk position of the meshed range, -1 for none
+    HorizonCuller horizonCuller; // Slabs of the meshed range, the camera is set while rendering
+
+    [[nodiscard]] const Entry* GetEntryAt(Vector3 chunkPos) const;
+};
+
+// Block data, streaming and meshing live on the simulation thread. Rendering only reads the latest published snapshot.
 class World {
     public:
-        explicit World(Camera *player);
+        // Chunks are saved to and loaded from region files in saveDirectory, distance is the initial render distance
+        World(Vector3 playerPosition, std::filesystem::path saveDirectory, int distance = 16);
         ~World();
 
-        void Update();
-
+        // Simulation thread
+        void Update(Vector3 playerPosition);
         void GenerateChunks();
-        void RenderChunks() const;
+        void PublishSnapshot();
+
+        // Render thread
+        void RenderChunks(const Camera& camera) const;
+        void SetUploadBudget(size_t bytesPerFrame);
+        [[nodiscard]] size_t GetUploadBudget() const;
+        [[nodiscard]] int GetPendingUploads() const; // Meshes the last frame had to leave for later
+        [[nodiscard]] size_t GetArenaBytes() const;  // Opaque chunk geometry on the GPU
+
+        // Any thread; picked up by the next tick
+        void SetRenderDistance(int distance);
+        [[nodiscard]] int GetRenderDistance() const;
+        void SetWorkerCount(int count);
+        [[nodiscard]] int GetWorkerCount() const;
+        // Whether chunks drop the CPU copy of their meshes once uploaded. Saves about as much memory as the meshes take on the GPU,
+        // but edits then rebuild whole chunk meshes instead of patching them, and so does the arena growing where buffers can't be copied on the GPU.
+        void SetFreeUploadedMeshes(bool enabled);
+        [[nodiscard]] bool GetFreeUploadedMeshes() const;
+        [[nodiscard]] static size_t GetCpuMeshBytes();
+        [[nodiscard]] ChunkIo::Stats GetIoStats() const; // Queue depths of chunk loads and saves
+        [[nodiscard]] ChunkCache::Stats GetCacheStats() const;
 
         [[nodiscard]] unsigned char GetBlockAt(int x, int y, int z) const;
+        void SetBlockAt(int x, int y, int z, unsigned char blockType);
+        [[nodiscard]] bool RaycastBlock(Vector3 origin, Vector3 direction, float maxDistance, std::array<int, 3>& hit, std::array<int, 3>& previous) const;
         [[nodiscard]] static Vector3 GetChunkPositionAt(Vector3 in);
         [[nodiscard]] std::shared_ptr<Chunk> GetChunkAt(Vector3 chunkPos) const;
         [[nodiscard]] bool IsBlockAtCoordsTransparent(int x, int y, int z) const;
+        [[nodiscard]] int GetLodLevelAt(Vector3 chunkPos) const;
+        // World y of the topmost block the generator places in a column, before caves are carved out
+        [[nodiscard]] int GetTerrainHeight(int x, int z) const;
 
     private:
         ResourceLoader loader;
 
         Music music;
 
+        // Declared before the chunks, which hand their GPU resources back to these when destroyed.
+        // Uploads happen while rendering, hence mutable.
+        mutable VertexArena opaqueArena{1 << 19};
+        mutable GpuReleaseQueue releaseQueue;
+        DecalRenderer decalRenderer;
+        mutable ChunkGpuContext gpuContext{opaqueArena, decalRenderer, releaseQueue};
+
         std::vector<std::shared_ptr<
             std::vector<std::shared_ptr<
                 std::vector<std::shared_ptr<Chunk>>
             >>
         >> chunks;
         Vector3 minChunkPos{}, maxChunkPos{};
+        ChunkCache chunkCache{64 * 1024 * 1024};
+        HorizonCuller horizonCuller; // Slabs of the meshed range
+
+        // Handed from the simulation to the render thread
+        std::shared_ptr<const RenderSnapshot> snapshot;
+        mutable std::mutex snapshotMutex;
 
         Material opaqueChunkMat {};
         Material transparentChunkMat {};
 
-        const siv::PerlinNoise::seed_type seed = GetRandomValue(0, 99999999);
-	    const siv::PerlinNoise perlin{ seed };
+        // Chunks leaving the loaded range are written out if they changed, and read back before being generated again.
+        // All disk access goes through the I/O thread, loaded chunks are picked up by later ticks.
+        RegionStore regionStore;
+        mutable ChunkIo chunkIo{regionStore};
+        const TerrainGenerator terrain{static_cast<siv::PerlinNoise::seed_type>(regionStore.LoadSeed(GetRandomValue(0, 99999999)))};
+        static constexpr unsigned char surfaceBlockType = 1;
+
+        // Beyond the loaded chunks; drawn while rendering, hence mutable
+        mutable FarTerrain farTerrain{[this](const int x, const int z) { return GetTerrainHeight(x, z) + 1; }};
 
-        Vector3 *playerPos;
-        const int renderDistance = 4;
+        Vector3 playerPos;
+        Vector3 playerLastChunk;
+        int renderDistance = 16; // Of the loaded range, only changed between ticks
+        const int verticalRenderDistance = 2; // The terrain is a heightmap, so only a few layers of chunks around the player's are loaded
+        std::atomic<int> requestedRenderDistance = renderDistance;
+        std::atomic<bool> freeUploadedMeshes = false;
+        std::atomic<int> workerCount = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)); // Threads filling in chunks
+        const int haloSize = 1; // Rings of chunks beyond the meshed range that only hold block data
+        static constexpr int allNeighborsMask = (1 << BlockModel::DirectionCount) - 1;
+        size_t uploadBytesPerFrame = 4 * 1024 * 1024; // Budget for mesh uploads, the rest waits for later frames
+        mutable int pendingUploads = 0;
+        const double uploadMillisecondsPerFrame = 2.0;
+        const std::chrono::seconds autosaveInterval{30}; // Loaded chunks that changed are saved and flushed this often
+        std::chrono::steady_clock::time_point lastAutosave = std::chrono::steady_clock::now();
+        const float decalDrawDistance = 48.0f; // Blocks from the player beyond which chunks skip their decals
+        // Fractions of the render distance at which meshes drop to 2x, 4x and 8x downsampled blocks
+        const std::array<float, 3> lodDistanceFractions = {0.25f, 0.5f, 0.75f};
+        const int minLodDistance = 2; // Chunks closer than this always get full resolution meshes, and every further level starts a ring later
 
-	    std::shared_ptr<Chunk> GenerateChunk(Vector3 chunkPos);
+        void SetLoadedRange(Vector3 centerChunk);
+        void ResetChunkGrid();
+        [[nodiscard]] bool IsInMeshRange(Vector3 chunkPos) const;
+        [[nodiscard]] int GetNeighborMask(Vector3 chunkPos) const;
+        [[nodiscard]] int GetLodSeams(Vector3 chunkPos, int lodLevel) const;
+        [[nodiscard]] static std::optional<tsl::hopscotch_set<const Chunk*>> FindVisibleChunks(const RenderSnapshot& frame, const Camera& camera);
+        void UpdateUploadedGeometry();
+        void UpdateHorizonSlabs();
+        void UpdateHorizonSlab(int x, int z);
+        void MeshChunks();
+        void ReceiveLoadedChunks();
+        void SaveChunk(Chunk& chunk);
+        void SaveLoadedChunks();
 };